@@ -0,0 +1,107 @@
+#include "AlertManager.h"
+#include <algorithm>
+
+AlertManager::AlertManager(double entrySeparation, double exitSeparation, double escalationTime)
+	: entrySeparation(entrySeparation), exitSeparation(exitSeparation), escalationTime(escalationTime) {}
+
+std::vector<msg_collision_alert> AlertManager::update(const std::vector<ConflictObservation>& observations) {
+	std::lock_guard<std::mutex> lock(alertsMutex);
+	std::vector<msg_collision_alert> changes;
+	std::map<std::pair<int,int>, AlertState> next;
+
+	for (const ConflictObservation& obs : observations) {
+		std::pair<int,int> key(std::min(obs.plane1, obs.plane2), std::max(obs.plane1, obs.plane2));
+		auto it = alerts.find(key);
+		bool active = it != alerts.end();
+
+		if (!active && obs.missDistance > entrySeparation) {
+			// Between entry and exit thresholds without an alert: stay quiet
+			continue;
+		}
+		if (active && obs.missDistance > exitSeparation) {
+			// Leave it out of `next`; reported as CLEARED below
+			continue;
+		}
+
+		bool imminent = obs.timeToClosestApproach <= escalationTime;
+		AlertState state;
+		AlertState reported;
+		if (!active) {
+			state = imminent ? AlertState::ESCALATED : AlertState::NEW;
+			reported = state;
+		} else if (it->second != AlertState::ESCALATED && imminent) {
+			state = AlertState::ESCALATED;
+			reported = state;
+		} else {
+			// Escalated alerts stay escalated until they clear
+			state = it->second == AlertState::ESCALATED ? AlertState::ESCALATED : AlertState::ONGOING;
+			reported = AlertState::ONGOING;
+		}
+		next[key] = state;
+
+		if (reported == AlertState::ONGOING) {
+			suppressed++;
+			continue;
+		}
+		changes.push_back(msg_collision_alert{key.first, key.second, reported, obs.timeToClosestApproach, obs.missDistance, obs.trace});
+	}
+
+	// Alerts not confirmed this cycle have cleared (separated, or a plane left)
+	for (const auto& entry : alerts) {
+		if (next.find(entry.first) == next.end()) {
+			changes.push_back(msg_collision_alert{entry.first.first, entry.first.second, AlertState::CLEARED, 0.0, 0.0, {}});
+		}
+	}
+
+	// A newer transition of the same pair supersedes the undelivered one
+	for (const msg_collision_alert& change : changes) {
+		pending.erase(std::make_pair(change.plane1, change.plane2));
+	}
+
+	alerts.swap(next);
+	transitions += changes.size();
+	return changes;
+}
+
+void AlertManager::unsent(const msg_collision_alert* failed, size_t count) {
+	std::lock_guard<std::mutex> lock(alertsMutex);
+	for (size_t i = 0; i < count; ++i) {
+		pending[std::make_pair(failed[i].plane1, failed[i].plane2)] = failed[i];
+	}
+}
+
+std::vector<msg_collision_alert> AlertManager::takeUnsent() {
+	std::lock_guard<std::mutex> lock(alertsMutex);
+	std::vector<msg_collision_alert> resend;
+	resend.reserve(pending.size());
+	for (const auto& entry : pending) {
+		resend.push_back(entry.second);
+	}
+	pending.clear();
+	return resend;
+}
+
+size_t AlertManager::activeAlerts() {
+	std::lock_guard<std::mutex> lock(alertsMutex);
+	return alerts.size();
+}
+
+std::vector<msg_alert_entry> AlertManager::snapshot() {
+	std::lock_guard<std::mutex> lock(alertsMutex);
+	std::vector<msg_alert_entry> active;
+	active.reserve(alerts.size());
+	for (const auto& entry : alerts) {
+		active.push_back(msg_alert_entry{entry.first.first, entry.first.second, entry.second});
+	}
+	return active;
+}
+
+bool AlertManager::involves(int planeID) {
+	std::lock_guard<std::mutex> lock(alertsMutex);
+	for (const auto& entry : alerts) {
+		if (entry.first.first == planeID || entry.first.second == planeID) {
+			return true;
+		}
+	}
+	return false;
+}
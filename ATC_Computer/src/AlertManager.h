@@ -0,0 +1,77 @@
+/*
+ * The AlertManager class keeps the state of every conflict alert so that the
+ * Display only hears about changes instead of the same conflict every cycle.
+ *
+ * *****Hysteresis*****:
+ * A pair raises an alert (NEW) when its predicted miss distance drops to the
+ * entry threshold, but only clears (CLEARED) once it grows past the larger
+ * exit threshold. Pairs oscillating around a single threshold therefore do not
+ * flap between alert and no alert.
+ *
+ * *****Escalation*****:
+ * An alert becomes ESCALATED when the closest approach is less than the
+ * escalation time away. Everything else in between is ONGOING and is not sent.
+ *
+ * *****Delivery*****:
+ * The state is committed by update(), before the alerts reach the Display. A
+ * transition that could not be delivered is handed back with unsent() and
+ * returned by takeUnsent() on the next cycle, unless the pair has changed state
+ * again in the meantime. snapshot() lists every active alert, for the periodic
+ * ALERT_SNAPSHOT that lets a Display started late catch up.
+ */
+
+#ifndef ALERTMANAGER_H_
+#define ALERTMANAGER_H_
+
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include "Msg_structs.h"
+
+// One pair evaluated by the conflict detector during a cycle
+struct ConflictObservation {
+	int plane1, plane2;
+	double timeToClosestApproach;
+	double missDistance;
+	latency_trace trace;  // Oldest aircraft state of the pair, carried by its NEW/ESCALATED alert
+};
+
+class AlertManager {
+public:
+	AlertManager(double entrySeparation = 500.0, double exitSeparation = 750.0, double escalationTime = 10.0);
+
+	// Feed all pairs observed within the exit threshold this cycle.
+	// Returns only the alerts that changed state (NEW, ESCALATED, CLEARED).
+	std::vector<msg_collision_alert> update(const std::vector<ConflictObservation>& observations);
+
+	// Keep transitions the Display did not receive, to be sent again next cycle
+	void unsent(const msg_collision_alert* failed, size_t count);
+	// Undelivered transitions still current, by pair; the caller now owns them
+	std::vector<msg_collision_alert> takeUnsent();
+
+	double getExitSeparation() const { return exitSeparation; }
+	size_t activeAlerts();
+	// Every active alert with its current state, ordered by pair
+	std::vector<msg_alert_entry> snapshot();
+
+	// True if the plane is part of any active alert (safe from any thread)
+	bool involves(int planeID);
+	uint64_t transitionsSent() const { return transitions; }
+	uint64_t updatesSuppressed() const { return suppressed; }
+
+private:
+	double entrySeparation;  // meters, raise alert at or below
+	double exitSeparation;   // meters, clear alert above
+	double escalationTime;   // seconds to closest approach
+
+	std::map<std::pair<int,int>, AlertState> alerts;  // Active alerts, key has plane1 < plane2
+	std::map<std::pair<int,int>, msg_collision_alert> pending;  // Undelivered transitions, latest per pair
+	std::mutex alertsMutex;  // update() runs on the monitor thread, involves() on the operator thread
+
+	uint64_t transitions = 0;  // State changes reported
+	uint64_t suppressed = 0;   // ONGOING updates that were not reported
+};
+
+#endif /* ALERTMANAGER_H_ */
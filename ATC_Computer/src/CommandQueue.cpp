@@ -0,0 +1,93 @@
+#include "CommandQueue.h"
+#include "TimeBase.h"
+
+CommandQueue::CommandQueue(size_t maxDepth, size_t criticalReserve)
+	: maxDepth(maxDepth), criticalReserve(criticalReserve < maxDepth ? criticalReserve : 0) {}
+
+bool CommandQueue::push(const Message& msg) {
+	std::lock_guard<std::mutex> lock(queueMutex);
+	if (stopping) {
+		return false;
+	}
+
+	size_t limit = msg.header.priority == CommandPriority::SEPARATION_CRITICAL ? maxDepth : maxDepth - criticalReserve;
+	if (queued >= limit) {
+		rejectedCount++;
+		return false;
+	}
+
+	perAircraft[msg.header.planeID].push_back(PendingCommand{msg, nextSequence++, TimeBase::nowNs()});
+	queued++;
+	available.notify_one();
+	return true;
+}
+
+// Pick the idle aircraft to serve next; caller holds queueMutex
+bool CommandQueue::selectAircraft(int& planeID) {
+	bool found = false;
+	bool bestCritical = false;
+	uint64_t bestSequence = 0;
+
+	for (const auto& entry : perAircraft) {
+		if (entry.second.empty() || busy.count(entry.first)) {
+			continue;
+		}
+		bool critical = false;
+		for (const PendingCommand& cmd : entry.second) {
+			if (cmd.msg.header.priority == CommandPriority::SEPARATION_CRITICAL) {
+				critical = true;
+				break;
+			}
+		}
+		uint64_t sequence = entry.second.front().sequence;
+		if (!found || (critical && !bestCritical) || (critical == bestCritical && sequence < bestSequence)) {
+			found = true;
+			bestCritical = critical;
+			bestSequence = sequence;
+			planeID = entry.first;
+		}
+	}
+	return found;
+}
+
+bool CommandQueue::pop(PendingCommand& command) {
+	std::unique_lock<std::mutex> lock(queueMutex);
+	int planeID = 0;
+	available.wait(lock, [&] { return selectAircraft(planeID) || (stopping && queued == 0); });
+	if (queued == 0) {
+		return false;  // Shut down and drained
+	}
+
+	std::deque<PendingCommand>& fifo = perAircraft[planeID];
+	command = fifo.front();
+	fifo.pop_front();
+	if (fifo.empty()) {
+		perAircraft.erase(planeID);
+	}
+	queued--;
+	busy.insert(planeID);
+	return true;
+}
+
+void CommandQueue::done(int planeID) {
+	std::lock_guard<std::mutex> lock(queueMutex);
+	busy.erase(planeID);
+	// The aircraft may have more commands waiting behind the one just delivered
+	available.notify_all();
+}
+
+void CommandQueue::shutdown() {
+	std::lock_guard<std::mutex> lock(queueMutex);
+	stopping = true;
+	available.notify_all();
+}
+
+size_t CommandQueue::depth() {
+	std::lock_guard<std::mutex> lock(queueMutex);
+	return queued;
+}
+
+uint64_t CommandQueue::rejected() {
+	std::lock_guard<std::mutex> lock(queueMutex);
+	return rejectedCount;
+}
@@ -0,0 +1,69 @@
+/*
+ * The CommandQueue class holds operator commands waiting to be delivered to
+ * aircraft by the CommunicationsSystem sender threads.
+ *
+ * *****Ordering*****:
+ * Commands for the same aircraft are delivered in the order they were queued,
+ * and never two at a time (an aircraft with a command in flight is "busy").
+ * Across aircraft, an aircraft with a SEPARATION_CRITICAL command pending is
+ * served before aircraft with only ROUTINE commands; ties go to the oldest
+ * command.
+ *
+ * *****Back-pressure*****:
+ * The queue holds at most maxDepth commands. ROUTINE commands are refused once
+ * the depth reaches maxDepth - criticalReserve, so that separation-critical
+ * commands always find room.
+ */
+
+#ifndef COMMANDQUEUE_H_
+#define COMMANDQUEUE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <cstdint>
+#include "Msg_structs.h"
+
+struct PendingCommand {
+	Message msg;
+	uint64_t sequence;     // Global enqueue order
+	uint64_t enqueueTime;  // monotonic_now_ns() when queued
+};
+
+class CommandQueue {
+public:
+	CommandQueue(size_t maxDepth = 64, size_t criticalReserve = 16);
+
+	// Queue a command; returns false when refused by back-pressure or after shutdown
+	bool push(const Message& msg);
+
+	// Block until a command can be delivered; returns false once shut down and drained
+	bool pop(PendingCommand& command);
+
+	// Mark the aircraft's in-flight command as delivered (or failed)
+	void done(int planeID);
+
+	void shutdown();
+
+	size_t depth();
+	uint64_t rejected();
+
+private:
+	bool selectAircraft(int& planeID);
+
+	size_t maxDepth;
+	size_t criticalReserve;
+	size_t queued = 0;
+	uint64_t nextSequence = 0;
+	uint64_t rejectedCount = 0;
+	bool stopping = false;
+
+	std::map<int, std::deque<PendingCommand>> perAircraft;  // FIFO per aircraft
+	std::set<int> busy;                                     // Aircraft with a command in flight
+	std::mutex queueMutex;
+	std::condition_variable available;
+};
+
+#endif /* COMMANDQUEUE_H_ */
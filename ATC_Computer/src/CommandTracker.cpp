@@ -0,0 +1,75 @@
+#include "CommandTracker.h"
+#include <iostream>
+#include "TimeBase.h"
+
+static const char* commandName(MessageType type) {
+	switch (type) {
+		case MessageType::REQUEST_CHANGE_OF_HEADING: return "change of heading";
+		case MessageType::REQUEST_CHANGE_POSITION:   return "change position";
+		case MessageType::REQUEST_CHANGE_ALTITUDE:   return "change altitude";
+		default:                                     return "other command";
+	}
+}
+
+CommandTracker::CommandTracker(double timeoutSec)
+	: timeoutNs(static_cast<uint64_t>(timeoutSec * 1e9)) {}
+
+uint32_t CommandTracker::nextSequence() {
+	return ++sequence;
+}
+
+CommandTracker::TypeStats& CommandTracker::statsFor(MessageType type) {
+	TypeStats& stats = perType[type];
+	if (!stats.latency) {
+		stats.latency.reset(new LatencyHistogram(std::string(commandName(type)) + " -> effect"));
+	}
+	return stats;
+}
+
+void CommandTracker::issued(int planeID, uint32_t sequence, MessageType type) {
+	std::lock_guard<std::mutex> lock(trackerMutex);
+	pending[std::make_pair(planeID, sequence)] = Pending{type, TimeBase::nowNs()};
+}
+
+void CommandTracker::observe(const std::vector<msg_plane_info>& frame, uint64_t frameTime) {
+	std::lock_guard<std::mutex> lock(trackerMutex);
+	if (pending.empty()) {
+		return;
+	}
+
+	// Commands are applied in order per aircraft, so an echoed sequence confirms every older one too
+	for (const msg_plane_info& plane : frame) {
+		auto it = pending.lower_bound(std::make_pair(plane.id, 0u));
+		while (it != pending.end() && it->first.first == plane.id && it->first.second <= plane.commandSeq) {
+			statsFor(it->second.type).latency->recordInterval(it->second.issueTime, frameTime);
+			it = pending.erase(it);
+		}
+	}
+
+	// Anything older than the timeout was never applied (lost, refused, or the plane left)
+	for (auto it = pending.begin(); it != pending.end();) {
+		if (frameTime > it->second.issueTime && frameTime - it->second.issueTime > timeoutNs) {
+			statsFor(it->second.type).timeouts++;
+			std::cerr << "CommandTracker: " << commandName(it->second.type) << " #" << it->first.second
+			          << " for plane " << it->first.first << " never applied.\n";
+			it = pending.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+void CommandTracker::printStats() {
+	std::lock_guard<std::mutex> lock(trackerMutex);
+	std::cout << "\n================= Command-to-Effect Latency =================\n";
+	LatencyHistogram::printHeader(std::cout);
+	for (auto& entry : perType) {
+		entry.second.latency->print(std::cout);
+	}
+	for (auto& entry : perType) {
+		if (entry.second.timeouts) {
+			std::cout << commandName(entry.first) << ": " << entry.second.timeouts << " timed out\n";
+		}
+	}
+	std::cout << "Still pending: " << pending.size() << "\n";
+}
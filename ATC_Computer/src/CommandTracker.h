@@ -0,0 +1,60 @@
+/*
+ * The CommandTracker class measures how long operator commands take to show
+ * up in the radar picture.
+ *
+ * ComputerSystem gives every forwarded command a sequence number and calls
+ * issued(). Aircraft echo the sequence number of the last command they applied
+ * in their next state (msg_plane_info::commandSeq). observe() matches each
+ * published frame against the pending commands and records the
+ * command-to-effect latency per command type. Commands still pending after
+ * the timeout are counted as never applied.
+ */
+
+#ifndef COMMANDTRACKER_H_
+#define COMMANDTRACKER_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include "Msg_structs.h"
+#include "LatencyHistogram.h"
+
+class CommandTracker {
+public:
+	CommandTracker(double timeoutSec = 5.0);
+
+	// Next sequence number to stamp on a command
+	uint32_t nextSequence();
+
+	// A command with this sequence number was sent towards planeID
+	void issued(int planeID, uint32_t sequence, MessageType type);
+
+	// Match a frame published at frameTime (monotonic ns) against pending commands
+	void observe(const std::vector<msg_plane_info>& frame, uint64_t frameTime);
+
+	void printStats();
+
+private:
+	struct Pending {
+		MessageType type;
+		uint64_t issueTime;
+	};
+	struct TypeStats {
+		std::unique_ptr<LatencyHistogram> latency;
+		uint64_t timeouts = 0;
+	};
+
+	TypeStats& statsFor(MessageType type);
+
+	uint64_t timeoutNs;
+	std::atomic<uint32_t> sequence{0};
+	std::map<std::pair<int, uint32_t>, Pending> pending;  // (planeID, sequence)
+	std::map<MessageType, TypeStats> perType;
+	std::mutex trackerMutex;
+};
+
+#endif /* COMMANDTRACKER_H_ */
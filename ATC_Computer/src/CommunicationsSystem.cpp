@@ -1,68 +1,189 @@
-#include "CommunicationsSystem.h"
-#include <iostream>
-#include <cstring>
-#include <cerrno>
-#include <unistd.h> // for usleep
-#include <sys/dispatch.h>
-
-void CommunicationsSystem::start() {
-    // Start the communications thread if not already running
-    if (!Communications_System.joinable()) {
-        Communications_System = std::thread(&CommunicationsSystem::HandleCommunications, this);
-    }
-}
-
-// Constructor
-CommunicationsSystem::CommunicationsSystem() {
-    std::cout << "CommunicationsSystem initialized.\n";
-
-    // Start the communications handling thread
-    Communications_System = std::thread(&CommunicationsSystem::HandleCommunications, this);
-}
-
-// Destructor
-CommunicationsSystem::~CommunicationsSystem() {
-    std::cout << "CommunicationsSystem shutting down.\n";
-
-    // Join the thread if running
-    if (Communications_System.joinable()) {
-        Communications_System.join();
-    }
-}
-
-// Thread function to handle incoming/outgoing messages
-void CommunicationsSystem::HandleCommunications() {
-    std::cout << "CommunicationsSystem thread running.\n";
-    name_attach_t* attach = name_attach(nullptr, "communications_channel", 0);
-    if (!attach) {
-        std::cerr << "CommunicationsSystem: name_attach failed: " << strerror(errno) << "\n";
-        return;
-    }
-    std::cout << "CommunicationsSystem: channel attached as 'communications_channel'.\n";
-
-    bool running = true;
-    while (running) {
-        Message_inter_process incoming;
-        int rcvid = MsgReceive(attach->chid, &incoming, sizeof(incoming), nullptr);
-        if (rcvid == -1) {
-            if (errno == EINTR) continue;
-            std::cerr << "CommunicationsSystem: MsgReceive failed: " << strerror(errno) << "\n";
-            break;
-        }
-
-        // Handle incoming message
-        messageAircraft(reinterpret_cast<const Message&>(incoming));
-
-        // Reply if needed
-        MsgReply(rcvid, EOK, nullptr, 0);
-    }
-
-    name_detach(attach, 0);
-    std::cout << "CommunicationsSystem thread exiting.\n";
-}
-
-// Send a message to an aircraft (placeholder)
-void CommunicationsSystem::messageAircraft(const Message& msg) {
-    // Implement message sending logic here
-    std::cout << "Sending message to aircraft ID " << msg.planeID << "\n";
-}
+#include "CommunicationsSystem.h"
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h> // for usleep
+#include "Ipc.h"
+#include "TimeBase.h"
+#include "ThreadProfile.h"
+#include "MemoryWarmup.h"
+
+void CommunicationsSystem::start() {
+    // Start the communications thread if not already running
+    if (!Communications_System.joinable()) {
+        Communications_System = std::thread(&CommunicationsSystem::HandleCommunications, this);
+    }
+    // Start the pool of sender threads delivering queued commands
+    while (static_cast<int>(senders.size()) < senderCount) {
+        senders.emplace_back(&CommunicationsSystem::SendCommands, this);
+    }
+}
+
+// Constructor
+CommunicationsSystem::CommunicationsSystem(int senderCount)
+    : server("communications_channel"), senderCount(senderCount) {
+    std::cout << "CommunicationsSystem initialized.\n";
+
+    // Start the communications handling thread and the sender pool
+    start();
+}
+
+// Destructor
+CommunicationsSystem::~CommunicationsSystem() {
+    std::cout << "CommunicationsSystem shutting down.\n";
+
+    // Stop taking commands: detaching the channel unblocks the receive thread
+    stopping.store(true);
+    server.detach();
+    if (Communications_System.joinable()) {
+        Communications_System.join();
+    }
+
+    // Let the senders drain the queue, then join them
+    commandQueue.shutdown();
+    for (std::thread& sender : senders) {
+        if (sender.joinable()) {
+            sender.join();
+        }
+    }
+    printStats();
+}
+
+// Thread function to handle incoming messages: commands are queued and acknowledged immediately,
+// so a slow aircraft never blocks the ComputerSystem operator channel
+void CommunicationsSystem::HandleCommunications() {
+    ThreadProfiles::apply("comms.receive");
+    MemoryWarmup::prefaultStack();
+    std::cout << "CommunicationsSystem thread running.\n";
+    if (!server.isAttached()) {
+        std::cerr << "CommunicationsSystem: attach failed: " << strerror(errno) << "\n";
+        return;
+    }
+    std::cout << "CommunicationsSystem: channel attached as 'communications_channel'.\n";
+
+    while (!stopping.load()) {
+        Message incoming;
+        size_t received = 0;
+        int rcvid = server.receive(&incoming, sizeof(incoming), received);
+        if (rcvid == -1) {
+            if (errno == EINTR) continue;
+            if (stopping.load()) break;  // Detached by the destructor
+            std::cerr << "CommunicationsSystem: receive failed: " << strerror(errno) << "\n";
+            break;
+        }
+        if (!incoming.valid(received)) {
+            std::cerr << "CommunicationsSystem: dropped message with bad header or length\n";
+            server.error(rcvid, EPROTO);
+            continue;
+        }
+
+        // Group commands are expanded into one queued command per aircraft, acknowledged in aggregate
+        if (incoming.header.type == MessageType::REQUEST_GROUP_COMMAND) {
+            msg_group_ack ack = queueGroupCommand(incoming);
+            server.reply(rcvid, EOK, &ack, sizeof(ack));
+            continue;
+        }
+
+        // Queue the command; a full queue pushes back on the sender
+        if (commandQueue.push(incoming)) {
+            server.reply(rcvid, EOK);
+        } else {
+            std::cerr << "CommunicationsSystem: command queue full, command for aircraft "
+                      << incoming.header.planeID << " refused.\n";
+            server.error(rcvid, EBUSY);
+        }
+    }
+
+    std::cout << "CommunicationsSystem thread exiting.\n";
+}
+
+// Expand a resolved group (ID_LIST) into individual aircraft commands
+msg_group_ack CommunicationsSystem::queueGroupCommand(const Message& msg) {
+    msg_group_ack ack {};
+    const msg_group_command* received = msg.get<msg_group_command>();
+    if (!received) {
+        std::cerr << "CommunicationsSystem: invalid group command payload\n";
+        return ack;
+    }
+    const msg_group_command& group = *received;
+
+    int count = std::min(std::max(group.count, 0), MAX_GROUP_IDS);
+    ack.matched = count;
+    if (group.command != MessageType::REQUEST_CHANGE_OF_HEADING && group.command != MessageType::REQUEST_CHANGE_POSITION
+        && group.command != MessageType::REQUEST_CHANGE_ALTITUDE) {
+        std::cerr << "CommunicationsSystem: group command of unsupported type "
+                  << static_cast<int>(group.command) << " refused\n";
+        ack.refused = count;
+        ack.refusedMask = count == 32 ? ~0u : (1u << count) - 1;
+        return ack;
+    }
+    for (int i = 0; i < count; ++i) {
+        Message command;
+        command.init(group.command, group.ids[i]);
+        command.header.priority = msg.header.priority;
+        command.header.sequence = msg.header.sequence;
+        if (group.command == MessageType::REQUEST_CHANGE_POSITION) {
+            *command.put<msg_change_position>() = group.position;
+        } else {
+            msg_change_heading& heading = *command.put<msg_change_heading>();
+            heading = group.heading;
+            heading.ID = group.ids[i];
+        }
+
+        if (commandQueue.push(command)) {
+            ack.queued++;
+        } else {
+            ack.refused++;
+            ack.refusedMask |= 1u << i;
+        }
+    }
+    return ack;
+}
+
+// Sender thread: deliver queued commands until the queue is shut down and drained
+void CommunicationsSystem::SendCommands() {
+    ThreadProfiles::apply("comms.send");
+    MemoryWarmup::prefaultStack();
+    PendingCommand command;
+    while (commandQueue.pop(command)) {
+        bool ok = messageAircraft(command.msg);
+        commandQueue.done(command.msg.header.planeID);
+
+        if (ok) {
+            delivered++;
+            uint64_t now = TimeBase::nowNs();
+            if (command.msg.header.priority == CommandPriority::SEPARATION_CRITICAL) {
+                criticalLatency.recordInterval(command.enqueueTime, now);
+            } else {
+                routineLatency.recordInterval(command.enqueueTime, now);
+            }
+        } else {
+            failed++;
+        }
+    }
+}
+
+// Send a message to an aircraft over its cached connection
+bool CommunicationsSystem::messageAircraft(const Message& msg) {
+    // Each aircraft has its own channel named "chris<planeID>"
+    std::string channelName = "chris" + std::to_string(msg.header.planeID);
+    if (!aircraftEndpoints.send(channelName, &msg, msg.size())) {
+        std::cerr << "CommunicationsSystem: failed to deliver command to aircraft " << msg.header.planeID << "\n";
+        return false;
+    }
+    std::cout << "CommunicationsSystem: command delivered to aircraft ID " << msg.header.planeID << "\n";
+    return true;
+}
+
+void CommunicationsSystem::printStats() {
+    std::cout << "\n================= Communications Queue =================\n"
+              << "Delivered: " << delivered.load() << "  Failed: " << failed.load()
+              << "  Refused (queue full): " << commandQueue.rejected()
+              << "  Queued now: " << commandQueue.depth() << "\n";
+    LatencyHistogram::printHeader(std::cout);
+    criticalLatency.print(std::cout);
+    routineLatency.print(std::cout);
+    aircraftEndpoints.printStats();
+}
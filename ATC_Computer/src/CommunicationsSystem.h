@@ -3,18 +3,42 @@
 
 #include <iostream>
 #include <thread>
-#include <sys/dispatch.h>
+#include <vector>
+#include <atomic>
 #include "Msg_structs.h"
+#include "CommandQueue.h"
+#include "EndpointManager.h"
+#include "LatencyHistogram.h"
+#include "Ipc.h"
 
 class CommunicationsSystem {
 public:
-	CommunicationsSystem();
+	CommunicationsSystem(int senderCount = 4);
 	~CommunicationsSystem();
 	void start();
+
+	// Enqueue-to-delivery latency per priority class, queue depth and counters
+	void printStats();
 private:
     void HandleCommunications();
-    void messageAircraft(const Message& msg);
+    void SendCommands();
+    bool messageAircraft(const Message& msg);
+    msg_group_ack queueGroupCommand(const Message& msg);
+    // Attached before the receive thread starts; detached by the destructor to unblock it
+    IpcServer server;
+    std::atomic<bool> stopping{false};
     std::thread Communications_System;
+
+    // Outbound command path: the receive thread only queues, senders deliver
+    CommandQueue commandQueue;
+    std::vector<std::thread> senders;
+    int senderCount;
+    EndpointManager aircraftEndpoints;
+
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<uint64_t> failed{0};
+    LatencyHistogram criticalLatency{"separation-critical enqueue -> delivery"};
+    LatencyHistogram routineLatency{"routine enqueue -> delivery"};
 };
 
 
@@ -1,25 +1,70 @@
 #include "ComputerSystem.h"
-#include "ATCTimer.h"
 #include <ctime>        // For std::time_t, std::localtime
 #include <iomanip>      // For std::put_time
 #include <cmath>
-#include <sys/dispatch.h>
+#include "Ipc.h"
 #include <cstring> // For memcpy
+#include <algorithm>
 #include <errno.h>
 
 // COEN320 Task 3.1, set the display channel name
 #define display_channel_name "chris_display"
 static constexpr const char* COMPUTER_SYSTEM_CHANNEL = "computer_system_channel";
 static constexpr const char* COMMUNICATIONS_CHANNEL = "communications_channel";
-#define COLLISION_CHANNEL "chris_collision"
 
-ComputerSystem::ComputerSystem() : shm_fd(-1), shared_mem(nullptr), running(false) {}
+static const char* alertStateName(AlertState state) {
+    switch (state) {
+        case AlertState::NEW:       return "NEW";
+        case AlertState::ONGOING:   return "ONGOING";
+        case AlertState::ESCALATED: return "ESCALATED";
+        case AlertState::CLEARED:   return "CLEARED";
+    }
+    return "UNKNOWN";
+}
+
+ComputerSystem::ComputerSystem(int sectorColumns, int sectorRows)
+    : sectors(sectorColumns, sectorRows,
+              std::min<int>(sectorColumns * sectorRows, std::max(1u, std::thread::hardware_concurrency())),
+              &ComputerSystem::closestApproach, CONFLICT_HORIZON, alerts.getExitSeparation()),
+      shm_fd(-1), shared_mem(nullptr), running(false) {}
 
 ComputerSystem::~ComputerSystem() {
     joinThread();
+    printLatencyReport();
+    predictor.printStats();
+    endpoints.printStats();
+    endpoints.closeAll();
+    traffic.stop();  // Before the frame it follows is unmapped
     cleanupSharedMemory();
 }
 
+std::vector<EndpointStats> ComputerSystem::getEndpointStats() {
+    return endpoints.getStats();
+}
+
+PredictionStats ComputerSystem::getPredictionStats() {
+    return predictor.getStats();
+}
+
+DeadlineStats ComputerSystem::getMonitorDeadlineStats() {
+    return monitorDeadline.getStats();
+}
+
+void ComputerSystem::printLatencyReport() {
+    std::cout << "\n================= Pipeline Latency =================\n";
+    LatencyHistogram::printHeader(std::cout);
+    pollLatency.print(std::cout);
+    publishLatency.print(std::cout);
+    readLatency.print(std::cout);
+    detectLatency.print(std::cout);
+    monitorDeadline.printStats();
+    sectors.printStats(std::cout);
+    traffic.printStats(std::cout);
+    commandTracker.printStats();
+    ThreadProfiles::printStats(std::cout);
+    MemoryWarmup::printReport(std::cout);
+}
+
 bool ComputerSystem::initializeSharedMemory() {
 	const char *name = "/radar_shm";
 
@@ -39,7 +84,8 @@ bool ComputerSystem::initializeSharedMemory() {
         // COEN320 Task 3.3
 		// Map the shared memory object into the process's address space
         // The shared memory should be mapped to "shared_mem" (check for errors)
-	    void *ptr = mmap(nullptr, SHARED_MEMORY_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, this->shm_fd, 0);
+	    // Locked and pre-faulted, so reading a frame never faults (huge pages where supported)
+	    void *ptr = MemoryWarmup::mapShared(this->shm_fd, SHARED_MEMORY_SIZE, PROT_READ | PROT_WRITE);
 	    if (ptr == MAP_FAILED) {
 	        fprintf(stderr, "mmap (write) failed: %s\n", strerror(errno));
 	        close(this->shm_fd);
@@ -47,6 +93,10 @@ bool ComputerSystem::initializeSharedMemory() {
 	    }
 	    this->shared_mem = static_cast<SharedMemory*>(ptr);
         std::cout << "Shared memory initialized successfully." << std::endl;
+        // Published by Lab4 before the radar segment, so it is normally there already
+        if (!TimeBase::attach()) {
+            std::cerr << "Time base " << TIME_BASE_SHM_NAME << " not available: using local time.\n";
+        }
         return true;
 	}
 }
@@ -68,6 +118,9 @@ bool ComputerSystem::startMonitoring() {
 
         // start operator input listener thread
         monitorOperatorInput = std::thread(&ComputerSystem::processMessage, this);
+
+        // Queries are a service to the operator: monitoring goes on without them
+        traffic.start(shared_mem);
         return true;
     } else {
         std::cerr << "Failed to initialize shared memory. Monitoring not started.\n";
@@ -81,51 +134,100 @@ void ComputerSystem::joinThread() {
 }
 
 void ComputerSystem::monitorAirspace() {
-	//std::cout << "Initial is_empty value: " << shared_mem->is_empty.load() << std::endl;
-	ATCTimer timer(1,0);
-	// Vector to store plane data
+	ThreadProfiles::apply("computer.monitor");
+	MemoryWarmup::prefaultStack();
+	// Vector to store plane data, with room for a full frame from the start
 	std::vector<msg_plane_info> plane_data_vector;
-	uint64_t timestamp;
-    // Keep monitoring indefinitely until `stopMonitoring` is called
-	while (shared_mem->is_empty.load()) {
-		std::cout << "Waiting for planes in airspace...\n";
-		timer.waitTimer();
-	}
+	MemoryWarmup::prefault(plane_data_vector, SHARED_MEMORY_MAX_PLANES);
+	uint64_t timestamp = 0;
+	bool planesSeen = false;
+	const long predictionPeriodMs = 1000 / predictionRateHz;
+
+	std::cout << "Waiting for planes in airspace...\n";
 
+    // Wake on every frame the Radar publishes, and every prediction period in between,
+    // until `running` is cleared
 	while (running) {
-		if (shared_mem->is_empty.load()) {
+		if (!waitForFrame(plane_data_vector, timestamp, predictionPeriodMs)) {
+			// No new frame yet: check conflicts on dead-reckoned positions
+			if (planesSeen) {
+				monitorDeadline.release();
+				checkCollision(timestamp, predictor.predict(TrackPredictor::now()), true);
+				monitorDeadline.complete();
+			}
+			continue;
+		}
+		monitorDeadline.release();
+
+		// Real frame: correct the tracks and record how far off the predictions were
+		predictor.update(plane_data_vector, TrackPredictor::now());
+		// Operator commands whose sequence number is now echoed have taken effect
+		commandTracker.observe(plane_data_vector, framePublishTime);
+
+		if (plane_data_vector.empty()) {
+			if (!planesSeen) {
+				continue;
+			}
 			std::cout << "No planes in airspace. Stopping monitoring.\n";
 			running = false;
 	        break;
-        } else {
-        	plane_data_vector.clear();
-        	// Print separator and timestamp
-            //std::cout << "\n================= Shared Memory Update =================\n";
-
-            // Display the timestamp in a readable format
-            timestamp = shared_mem->timestamp;
-            //std::cout << "Last Update Timestamp: " << timestamp << "\n";
-            //std::cout << "Number of planes in shared memory: " << shared_mem->count << "\n";
-
-            for (int i = 0; i < shared_mem->count; ++i) {
-            	const msg_plane_info& plane = shared_mem->plane_data[i];
-            	// Store the plane info in the vector
-            	plane_data_vector.push_back(plane);
-            }
         }
+		planesSeen = true;
+
 		//**************Call Collision Detector*********************
-		if (plane_data_vector.size()>1)
-            checkCollision(timestamp, plane_data_vector);
-		else
-            std::cout << "No collision possible with single plane\n";
-        // Sleep for a short interval before the next poll
-       timer.waitTimer();
+		// Runs even with a single plane so that alerts of departed planes are cleared
+        checkCollision(timestamp, plane_data_vector);
+        detectLatency.recordInterval(frameReadTime, TimeBase::nowNs());
+        monitorDeadline.complete();
     }
-	std::cout << "Exiting monitoring loop." << std::endl;
+	std::cout << "Exiting monitoring loop. Skipped frames: " << skippedFrames
+	          << ", alert transitions sent: " << alerts.transitionsSent()
+	          << ", ongoing updates suppressed: " << alerts.updatesSuppressed() << std::endl;
+}
+
+// Block until the Radar publishes a generation newer than the last one processed.
+// The frame is copied out under frame_mutex so it is always complete.
+// Returns false if no new frame arrived within timeoutMs.
+bool ComputerSystem::waitForFrame(std::vector<msg_plane_info>& planes, uint64_t& timestamp, long timeoutMs) {
+	struct timespec deadline;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += timeoutMs / 1000;
+	deadline.tv_nsec += (timeoutMs % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000L) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+
+	pthread_mutex_lock(&shared_mem->frame_mutex);
+	while (shared_mem->generation == lastGeneration) {
+		if (pthread_cond_timedwait(&shared_mem->frame_cond, &shared_mem->frame_mutex, &deadline) == ETIMEDOUT) {
+			pthread_mutex_unlock(&shared_mem->frame_mutex);
+			return false;
+		}
+	}
+
+	uint64_t generation = shared_mem->generation;
+	if (lastGeneration != 0 && generation > lastGeneration + 1) {
+		skippedFrames += generation - lastGeneration - 1;
+	}
+	lastGeneration = generation;
+
+	timestamp = shared_mem->timestamp;
+	planes.assign(shared_mem->plane_data, shared_mem->plane_data + (shared_mem->is_empty.load() ? 0 : shared_mem->count));
+	framePublishTime = shared_mem->publish_time;
+	pthread_mutex_unlock(&shared_mem->frame_mutex);
+	frameReadTime = TimeBase::nowNs();
+
+	// Per-plane stages of this frame
+	for (const msg_plane_info& plane : planes) {
+		pollLatency.recordInterval(plane.stateTime, plane.pollTime);
+		publishLatency.recordInterval(plane.pollTime, framePublishTime);
+	}
+	readLatency.recordInterval(framePublishTime, frameReadTime);
+	return true;
 }
 
-void ComputerSystem::checkCollision(uint64_t currentTime, std::vector<msg_plane_info> planes) {
-    std::cout << "Checking for collisions at time: " << currentTime << std::endl;
+void ComputerSystem::checkCollision(uint64_t currentTime, std::vector<msg_plane_info> planes, bool predicted) {
     // COEN320 Task 3.4
     // detect collisions between planes in the airspace within the time constraint
     // You need to Iterate through each pair of planes and in case of collision,
@@ -135,76 +237,96 @@ void ComputerSystem::checkCollision(uint64_t currentTime, std::vector<msg_plane_
     // in case of collision, send message to Display system
     /*
     HINT:
-    In case of collision a Message (type Message_inter_process) should be sent to the Display system
-    The data field of the message should contain the list of pairs of plane IDs that are predicted to collide
-    Make sure to fill dataSize field of the message appropriately
-    e.g. (here a std::pair<int,int> is used to represent a pair of colliding planes)
+    In case of collision a Message should be sent to the Display system
+    Its payload is the list of alerts, built in place with put<T>(count),
+    which also sets the payload length in the header
     // Prepare the message
-    Message_inter_process msg_to_send;
-    std::vector<std::pair<int, int>> collisionPairs;
-    // Store the collision pair plane ID 0 and 1
-    collisionPairs.emplace_back(<plane 0>, <plane 1>);
-    // Serialize collisionPairs
-    size_t numPairs = collisionPairs.size();
-    size_t dataSize = numPairs * sizeof(std::pair<int, int>);
-
-    msg_to_send.planeID = -1;
-    msg_to_send.type = MessageType::COLLISION_DETECTED;
-    msg_to_send.dataSize = dataSize;
-    std::memcpy(msg_to_send.data.data(), collisionPairs.data(), dataSize);
+    Message msg_to_send;
+    msg_to_send.init(MessageType::COLLISION_DETECTED);
+    msg_collision_alert* alerts = msg_to_send.put<msg_collision_alert>(count);
+    // Fill alerts[0..count) (plane IDs, state, time to closest approach...)
     sendCollisionToDisplay(msg_to_send);
 
     */
-    name_attach_t* attach = name_attach(nullptr, COLLISION_CHANNEL, 0);
-    std::cout << "Checking for collisions at time: " << currentTime << " with " << planes.size() << " planes\n";
-
-    std::vector<std::pair<int,int>> collisionPairs;
-    size_t n = planes.size();
-
-    for (size_t i = 0; i < n; ++i) {
-        for (size_t j = i + 1; j < n; ++j) {
-            if (checkAxes(planes[i], planes[j])) {
-                collisionPairs.emplace_back(planes[i].id, planes[j].id);
-                std::cout << "Predicted collision: " << planes[i].id << " <-> " << planes[j].id << "\n";
+    std::vector<ConflictObservation> observations;
+
+    // Report every pair inside the exit threshold; the alert manager applies hysteresis.
+    // Same pairs, in the same order, as one pass over every pair of the frame.
+    sectors.detect(planes, observations);
+    uint64_t detectTime = TimeBase::nowNs();
+
+    // Pipeline trace of the oldest aircraft state behind each pair; cleared alerts carry none.
+    // A predicted cycle runs up to a radar period after the frame was read, so its alerts
+    // leave read unstamped rather than charge that wait to "read -> detect".
+    for (ConflictObservation& obs : observations) {
+        for (const msg_plane_info& plane : planes) {
+            if ((plane.id == obs.plane1 || plane.id == obs.plane2) &&
+                (obs.trace.state == 0 || plane.stateTime < obs.trace.state)) {
+                obs.trace.state = plane.stateTime;
+                obs.trace.poll = plane.pollTime;
             }
         }
+        obs.trace.publish = framePublishTime;
+        obs.trace.read = predicted ? 0 : frameReadTime;
+        obs.trace.detect = detectTime;
     }
 
-    if (collisionPairs.empty()) {
-        std::cout << "No collisions predicted in this update.\n";
-        return;
+    // Only state transitions (new, escalated, cleared) go to the Display
+    std::vector<msg_collision_alert> changes = alerts.update(observations);
+    for (const msg_collision_alert& change : changes) {
+        std::cout << "Conflict " << change.plane1 << " <-> " << change.plane2
+                  << " " << alertStateName(change.state) << " at time " << currentTime << "\n";
     }
 
-    // Prepare inter-process message
-    Message_inter_process msg_to_send;
-
-    msg_to_send.planeID = -1;
-    msg_to_send.type = MessageType::COLLISION_DETECTED;
-
-    size_t numPairs = collisionPairs.size();
-    size_t dataSize = numPairs * sizeof(std::pair<int,int>);
+    // Transitions a previous cycle failed to deliver go out first
+    std::vector<msg_collision_alert> outgoing = alerts.takeUnsent();
+    outgoing.insert(outgoing.end(), changes.begin(), changes.end());
+
+    const size_t perMessage = PAYLOAD_CAPACITY(msg_collision_alert);
+    for (size_t first = 0; first < outgoing.size(); first += perMessage) {
+        size_t count = std::min(perMessage, outgoing.size() - first);
+
+        // Prepare inter-process message, alerts written straight into its payload
+        Message msg_to_send;
+        msg_to_send.init(MessageType::COLLISION_DETECTED);
+        msg_collision_alert* payload = msg_to_send.put<msg_collision_alert>(count);
+        uint64_t sendTime = TimeBase::nowNs();
+        for (size_t k = first; k < first + count; ++k) {
+            payload[k - first] = outgoing[k];
+            if (outgoing[k].state != AlertState::CLEARED) {
+                payload[k - first].trace.send = sendTime;
+            }
+        }
 
-    if (dataSize > msg_to_send.data.size()) {
-        std::cerr << "Collision data too large to send (" << dataSize << " bytes). Truncating.\n";
-        // truncate
-        size_t fitPairs = msg_to_send.data.size() / sizeof(std::pair<int,int>);
-        dataSize = fitPairs * sizeof(std::pair<int,int>);
+        // Send; an undelivered batch is kept by the alert manager and retried next cycle
+        try {
+            sendCollisionToDisplay(msg_to_send);
+            displayUnreachable = false;
+        } catch (const std::exception& ex) {
+            if (!displayUnreachable) {
+                std::cerr << "Failed to send collision message, retrying every cycle: " << ex.what() << "\n";
+            }
+            displayUnreachable = true;
+            alerts.unsent(&outgoing[first], count);
+        }
     }
 
-    // Copy memory
-    std::memcpy(msg_to_send.data.data(), collisionPairs.data(), dataSize);
-    msg_to_send.dataSize = static_cast<int>(dataSize);
-
-    // Send
-    try {
-        sendCollisionToDisplay(msg_to_send);
-    } catch (const std::exception& ex) {
-        std::cerr << "Failed to send collision message: " << ex.what() << "\n";
+    // The full active set now and then, for a Display that started late or lost transitions
+    if (detectTime - lastSnapshotTime >= ALERT_SNAPSHOT_PERIOD_MS * 1000000ULL) {
+        lastSnapshotTime = detectTime;
+        sendAlertSnapshot();
     }
-    
 }
 
 bool ComputerSystem::checkAxes(msg_plane_info p1, msg_plane_info p2) {
+    const double sepThreshold = 500.0;   // meters separation threshold
+    double tca;
+    return closestApproach(p1, p2, tca) <= sepThreshold;
+}
+
+// Miss distance (meters) at the closest point of approach within the look-ahead horizon;
+// tca receives the time (seconds) until that point.
+double ComputerSystem::closestApproach(const msg_plane_info& p1, const msg_plane_info& p2, double& tca) {
     // COEN320 Task 3.4
     // A collision is defined as two planes entering the defined airspace constraints within the time constraint
     // You need to implement the logic to check if plane1 and plane2 will collide within the time constraint
@@ -214,9 +336,7 @@ bool ComputerSystem::checkAxes(msg_plane_info p1, msg_plane_info p2) {
     // and checking if those future positions will be within the defined constraints within the time constraint
     // p1/p2 have PositionX/Y/Z and VelocityX/Y/Z in same units.
     // Choose parameters:
-    const double timeHorizon = 30.0;     // seconds to look ahead
-    const double sepThreshold = 500.0;   // meters separation threshold
-    // Collision using threshold and time (default set: alert when they are 500 meters within the next 30 seconds)
+    const double timeHorizon = CONFLICT_HORIZON;
 
     // Relative position and velocity
     double rx = p2.PositionX - p1.PositionX;
@@ -230,7 +350,6 @@ bool ComputerSystem::checkAxes(msg_plane_info p1, msg_plane_info p2) {
     double v2 = vx*vx + vy*vy + vz*vz;
     double rdotv = rx*vx + ry*vy + rz*vz;
 
-    double tca;
     if (v2 < 1e-6) {
         // Relative velocity near zero, check current distance
         tca = 0.0;
@@ -245,117 +364,150 @@ bool ComputerSystem::checkAxes(msg_plane_info p1, msg_plane_info p2) {
     double cy = ry + vy * tca;
     double cz = rz + vz * tca;
 
-    double dist2 = cx*cx + cy*cy + cz*cz;
-    bool collision = dist2 <= (sepThreshold * sepThreshold);
-
-    return collision;
+    return std::sqrt(cx*cx + cy*cy + cz*cz);
 }
 
 
-void ComputerSystem::sendCollisionToDisplay(const Message_inter_process& msg){
-	int display_channel = name_open(display_channel_name, 0);
-	if (display_channel == -1) {
-		throw std::runtime_error("Computer system: Error occurred while attaching to display");
+void ComputerSystem::sendCollisionToDisplay(const Message& msg){
+	// Connection to the display is resolved once and reused for every alert
+	if (!endpoints.send(display_channel_name, &msg, msg.size())) {
+		throw std::runtime_error("Computer system: Error occurred while sending message to display channel");
 	}
-	int reply;
+}
 
-	int status = MsgSend(display_channel, &msg, sizeof(msg), &reply, sizeof(reply));
-	if (status == -1) {
-		perror("Computer system: Error occurred while sending message to display channel");
+// Send every active alert as one ALERT_SNAPSHOT, in as many parts as it takes.
+// The Display replaces its conflict set once the last part arrives.
+void ComputerSystem::sendAlertSnapshot() {
+	std::vector<msg_alert_entry> active = alerts.snapshot();
+	size_t parts = std::max<size_t>(1, (active.size() + ALERT_SNAPSHOT_PART_ALERTS - 1) / ALERT_SNAPSHOT_PART_ALERTS);
+	uint32_t snapshot = ++alertSnapshots;
+
+	for (size_t part = 0; part < parts; ++part) {
+		size_t first = part * ALERT_SNAPSHOT_PART_ALERTS;
+		size_t count = std::min<size_t>(ALERT_SNAPSHOT_PART_ALERTS, active.size() - first);
+
+		Message msg;
+		msg.init(MessageType::ALERT_SNAPSHOT);
+		msg_alert_snapshot* payload = msg.put<msg_alert_snapshot>();
+		payload->snapshot = snapshot;
+		payload->part = static_cast<uint16_t>(part);
+		payload->parts = static_cast<uint16_t>(parts);
+		payload->count = static_cast<int>(count);
+		std::copy(active.begin() + first, active.begin() + first + count, payload->alerts);
+
+		// A lost part only delays the Display until the next snapshot
+		if (!endpoints.send(display_channel_name, &msg, msg.size())) {
+			if (!displayUnreachable) {
+				std::cerr << "Failed to send alert snapshot: " << strerror(errno) << "\n";
+			}
+			displayUnreachable = true;
+			return;
+		}
+		displayUnreachable = false;
 	}
 }
 
 // Message processor
 void ComputerSystem::processMessage() {
+    ThreadProfiles::apply("computer.operator");
+    MemoryWarmup::prefaultStack();
     // Create a named channel
-    name_attach_t* attach = name_attach(nullptr, COMPUTER_SYSTEM_CHANNEL, 0);
-    if (attach == nullptr) {
-        std::cerr << "ComputerSystem: name_attach failed: " << strerror(errno) << "\n";
+    IpcServer server(COMPUTER_SYSTEM_CHANNEL);
+    if (!server.isAttached()) {
+        std::cerr << "ComputerSystem: attach failed: " << strerror(errno) << "\n";
         return;
     }
 
     std::cout << "ComputerSystem: operator channel attached as '" << COMPUTER_SYSTEM_CHANNEL << "'.\n";
 
     while (running.load()) {
-        Message_inter_process incoming {};
-        int rcvid = MsgReceive(attach->chid, &incoming, sizeof(incoming), nullptr);
+        Message incoming;
+        size_t received = 0;
+        int rcvid = server.receive(&incoming, sizeof(incoming), received);
         if (rcvid == -1) {
             if (errno == EINTR) continue;
-            std::cerr << "ComputerSystem: MsgReceive error: " << strerror(errno) << "\n";
+            std::cerr << "ComputerSystem: receive error: " << strerror(errno) << "\n";
             break;
         }
+        if (!incoming.valid(received)) {
+            std::cerr << "ComputerSystem: dropped message with bad header (wire version "
+                      << static_cast<int>(incoming.header.version) << ", " << received << " bytes)\n";
+            server.error(rcvid, EPROTO);
+            continue;
+        }
+
+        msg_group_ack groupAck {};
+        bool hasGroupAck = false;
+        bool refused = false;
 
         // handle message
         try {
-            switch (incoming.type) {
+            switch (incoming.header.type) {
+                case MessageType::REQUEST_GROUP_COMMAND:
+                    groupAck = applyGroupCommand(incoming);
+                    hasGroupAck = true;
+                    break;
+
                 case MessageType::REQUEST_CHANGE_OF_HEADING:
                 case MessageType::REQUEST_CHANGE_POSITION:
                 case MessageType::REQUEST_CHANGE_ALTITUDE:
-                    // Forward to Communications system to reach aircraft
-                    applyOperatorCommand(incoming);
-                    sendMessagesToComms(reinterpret_cast<const Message&>(incoming));
+                    // Forward to Communications system, which queues and delivers to the aircraft
+                    refused = !applyOperatorCommand(incoming);
+                    break;
+
+                case MessageType::REQUEST_LATENCY_REPORT:
+                    printLatencyReport();
                     break;
 
                 case MessageType::CHANGE_TIME_CONSTRAINT_COLLISIONS:
-                    handleTimeConstraintChange(reinterpret_cast<const Message&>(incoming));
+                    handleTimeConstraintChange(incoming);
                     break;
 
                 default:
                     // For other message types, log and ignore or handle as needed.
                     std::cout << "ComputerSystem: Received unsupported message type: "
-                              << static_cast<int>(incoming.type) << "\n";
+                              << static_cast<int>(incoming.header.type) << "\n";
                     break;
             }
         } catch (const std::exception& ex) {
             std::cerr << "ComputerSystem: exception while processing message: " << ex.what() << "\n";
         }
 
-        // Reply to the sender if necessary. If MsgReceive was used with MsgSend (coid/MsgSend),
-        // a reply may be required. We'll use MsgReply with 0 status.
-        MsgReply(rcvid, EOK, nullptr, 0);
+        // Every send blocks until it is replied to; reply with EOK status.
+        // Group commands get their aggregate acknowledgement as the reply, and a
+        // command CommunicationsSystem did not take is refused with EBUSY.
+        if (refused) {
+            server.error(rcvid, EBUSY);
+        } else if (hasGroupAck) {
+            server.reply(rcvid, EOK, &groupAck, sizeof(groupAck));
+        } else {
+            server.reply(rcvid, EOK);
+        }
     }
 
-    name_detach(attach, 0);
     std::cout << "ComputerSystem: operator message loop exiting.\n";
 }
 
-void ComputerSystem::sendMessagesToComms(const Message& msg) {
-    // Attempt to open communications channel and forward the raw Message_inter_process bytes.
-    // Since Message_inter_process and Message may differ, prefer sending Message_inter_process if available.
-    Message_inter_process mip {};
-    // If msg is actually a Message_inter_process in disguise, copy bytes.
-    std::memcpy(&mip, &msg, std::min(sizeof(mip), sizeof(msg)));
-
-    int comm_coid = name_open(COMMUNICATIONS_CHANNEL, 0);
-    if (comm_coid == -1) {
-        std::cerr << "ComputerSystem: name_open failed for '" << COMMUNICATIONS_CHANNEL
-                  << "': " << strerror(errno) << ". Command not forwarded.\n";
-        return;
-    }
-
-    int rc = MsgSend(comm_coid, &mip, sizeof(mip), nullptr, 0);
-    if (rc == -1) {
-        std::cerr << "ComputerSystem: MsgSend to Communications system failed: "
-                  << strerror(errno) << "\n";
-    } else {
-        std::cout << "ComputerSystem: forwarded command to CommunicationsSystem.\n";
+bool ComputerSystem::sendMessagesToComms(const Message& msg) {
+    // CommunicationsSystem only queues the command, so this returns without waiting for the aircraft.
+    // A full queue is reported as EBUSY.
+    if (!endpoints.send(COMMUNICATIONS_CHANNEL, &msg, msg.size())) {
+        std::cerr << "ComputerSystem: command not forwarded to CommunicationsSystem.\n";
+        return false;
     }
-    name_close(comm_coid);
+    std::cout << "ComputerSystem: forwarded command to CommunicationsSystem.\n";
+    return true;
 }
 
 void ComputerSystem::handleTimeConstraintChange(const Message& msg) {
-    // The operator packed an int into data; ensure sizes are valid
-    // We'll interpret msg as Message_inter_process layout (fixed array), so cast:
-    const Message_inter_process* mip = reinterpret_cast<const Message_inter_process*>(&msg);
-    if (!mip) return;
-
-    if (mip->dataSize < sizeof(int)) {
+    // The operator sent an int payload
+    const int* freq = msg.get<int>();
+    if (!freq) {
         std::cerr << "handleTimeConstraintChange: invalid payload size\n";
         return;
     }
 
-    int newFreq = 0;
-    std::memcpy(&newFreq, mip->data.data(), sizeof(int));
+    int newFreq = *freq;
     if (newFreq <= 0) {
         std::cerr << "handleTimeConstraintChange: invalid frequency " << newFreq << "\n";
         return;
@@ -366,25 +518,108 @@ void ComputerSystem::handleTimeConstraintChange(const Message& msg) {
               << timeConstraintCollisionFreq << " seconds.\n";
 }
 
-void ComputerSystem::applyOperatorCommand(const Message_inter_process& msg) {
-    // Each aircraft has its own channel named "chris<planeID>"
-    std::string channelName = "chris" + std::to_string(msg.planeID);
-    int plane_coid = name_open(channelName.c_str(), 0);
-    if (plane_coid == -1) {
-        std::cerr << "Failed to open channel for plane " << msg.planeID
-                  << ": " << strerror(errno) << "\n";
-        return;
+bool ComputerSystem::applyOperatorCommand(Message& command) {
+    // The operator's message is forwarded as is, after stamping its header.
+    // Commands for planes in an active conflict jump ahead of routine traffic
+    command.header.priority = alerts.involves(command.header.planeID) ? CommandPriority::SEPARATION_CRITICAL
+                                                                      : CommandPriority::ROUTINE;
+    // The aircraft echoes this sequence number once the command is applied
+    command.header.sequence = commandTracker.nextSequence();
+    if (!sendMessagesToComms(command)) {
+        return false;
     }
+    commandTracker.issued(command.header.planeID, command.header.sequence, command.header.type);
+    return true;
+}
 
-    // Forward the message directly to the aircraft
-    int rc = MsgSend(plane_coid, &msg, sizeof(msg), nullptr, 0);
-    if (rc == -1) {
-        std::cerr << "Failed to send operator command to plane " << msg.planeID
-                  << ": " << strerror(errno) << "\n";
-    } else {
-        std::cout << "Operator command sent to plane " << msg.planeID << "\n";
-    }
 
-    name_close(plane_coid);
+// Resolve a group selector against the frame currently in shared memory
+std::vector<int> ComputerSystem::resolveGroup(const msg_group_command& group) {
+    std::vector<int> selected;
+    int requested = std::min(std::max(group.count, 0), MAX_GROUP_IDS);
+
+    pthread_mutex_lock(&shared_mem->frame_mutex);
+    int count = shared_mem->is_empty.load() ? 0 : shared_mem->count;
+    for (int i = 0; i < count; ++i) {
+        const msg_plane_info& p = shared_mem->plane_data[i];
+        bool match = false;
+        switch (group.selector) {
+            case GroupSelector::ID_LIST:
+                match = std::find(group.ids, group.ids + requested, p.id) != group.ids + requested;
+                break;
+            case GroupSelector::BOX:
+                match = p.PositionX >= group.minX && p.PositionX <= group.maxX &&
+                        p.PositionY >= group.minY && p.PositionY <= group.maxY &&
+                        p.PositionZ >= group.minZ && p.PositionZ <= group.maxZ;
+                break;
+            case GroupSelector::ALTITUDE_BAND:
+                match = p.PositionZ >= group.minZ && p.PositionZ <= group.maxZ;
+                break;
+        }
+        if (match) {
+            selected.push_back(p.id);
+        }
+    }
+    pthread_mutex_unlock(&shared_mem->frame_mutex);
+    return selected;
 }
 
+msg_group_ack ComputerSystem::applyGroupCommand(const Message& msg) {
+    msg_group_ack ack {};
+    const msg_group_command* received = msg.get<msg_group_command>();
+    if (!received) {
+        std::cerr << "applyGroupCommand: invalid payload size\n";
+        return ack;
+    }
+    const msg_group_command& group = *received;
+    if (group.command != MessageType::REQUEST_CHANGE_OF_HEADING && group.command != MessageType::REQUEST_CHANGE_POSITION
+        && group.command != MessageType::REQUEST_CHANGE_ALTITUDE) {
+        std::cerr << "applyGroupCommand: unsupported command type " << static_cast<int>(group.command) << "\n";
+        return ack;
+    }
+
+    std::vector<int> selected = resolveGroup(group);
+    ack.matched = static_cast<int>(selected.size());
+
+    // Split by priority so planes in conflict are queued as separation-critical
+    std::vector<int> critical, routine;
+    for (int id : selected) {
+        (alerts.involves(id) ? critical : routine).push_back(id);
+    }
+
+    // Every aircraft of the group echoes the same sequence number
+    uint32_t sequence = commandTracker.nextSequence();
+
+    // One batch message to CommunicationsSystem per priority class (and per MAX_GROUP_IDS planes)
+    for (const std::vector<int>* ids : {&critical, &routine}) {
+        for (size_t first = 0; first < ids->size(); first += MAX_GROUP_IDS) {
+            Message out;
+            out.init(MessageType::REQUEST_GROUP_COMMAND);
+            out.header.priority = ids == &critical ? CommandPriority::SEPARATION_CRITICAL : CommandPriority::ROUTINE;
+            out.header.sequence = sequence;
+            msg_group_command& batch = *out.put<msg_group_command>();
+            batch = group;
+            batch.selector = GroupSelector::ID_LIST;
+            batch.count = static_cast<int>(std::min<size_t>(MAX_GROUP_IDS, ids->size() - first));
+            std::copy(ids->begin() + first, ids->begin() + first + batch.count, batch.ids);
+
+            msg_group_ack batchAck {};
+            if (endpoints.send(COMMUNICATIONS_CHANNEL, &out, out.size(), &batchAck, sizeof(batchAck))) {
+                ack.queued += batchAck.queued;
+                ack.refused += batchAck.refused;
+                // Only the commands actually queued are expected to take effect
+                for (int i = 0; i < batch.count; ++i) {
+                    if (!(batchAck.refusedMask & (1u << i))) {
+                        commandTracker.issued(batch.ids[i], sequence, group.command);
+                    }
+                }
+            } else {
+                ack.refused += batch.count;
+            }
+        }
+    }
+
+    std::cout << "ComputerSystem: group command matched " << ack.matched << " aircraft, "
+              << ack.queued << " queued, " << ack.refused << " refused.\n";
+    return ack;
+}
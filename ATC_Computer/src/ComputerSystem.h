@@ -15,39 +15,108 @@
 const double CONSTRAINT_X = 3000;
 const double CONSTRAINT_Y = 3000;
 const double CONSTRAINT_Z = 1000;
+const double CONFLICT_HORIZON = 30.0;  // seconds the conflict check looks ahead
+const long ALERT_SNAPSHOT_PERIOD_MS = 2000;  // Full set of active alerts resent to the Display
 
 #include "Msg_structs.h"  // Include the structure definition for msg_plane_info
+#include "EndpointManager.h"
+#include "TrackPredictor.h"
+#include "AlertManager.h"
+#include "LatencyHistogram.h"
+#include "ATCTimer.h"
+#include "DeadlineMonitor.h"
+#include "CommandTracker.h"
+#include "TimeBase.h"
+#include "ThreadProfile.h"
+#include "MemoryWarmup.h"
+#include "SectorDetector.h"
+#include "TrafficQueryService.h"
 
 #define SHARED_MEMORY_SIZE sizeof(SharedMemory)
 
 class ComputerSystem {
 public:
-    ComputerSystem();
+    // The conflict check is split over sectorColumns x sectorRows sectors (see SectorDetector)
+    ComputerSystem(int sectorColumns = 2, int sectorRows = 2);
     ~ComputerSystem();
 
     bool startMonitoring();
     void joinThread();
     void start();
-    void applyOperatorCommand(const Message_inter_process& msg);
+    // Returns false if CommunicationsSystem did not take the command (queue full or unreachable)
+    bool applyOperatorCommand(Message& command);
+
+    // Fan one command out to every aircraft matching the selector; returns the aggregate ack
+    msg_group_ack applyGroupCommand(const Message& msg);
+
+    // Per-peer IPC statistics (sends, reconnects, send latency)
+    std::vector<EndpointStats> getEndpointStats();
+
+    // Dead-reckoning error measured each time a real frame arrives
+    PredictionStats getPredictionStats();
+
+    // Per-stage latency (p50/p99/max) from aircraft state to conflict check
+    void printLatencyReport();
+
+    // Execution time, jitter and deadline misses of the monitoring loop
+    DeadlineStats getMonitorDeadlineStats();
 
 private:
     void monitorAirspace();
+    bool waitForFrame(std::vector<msg_plane_info>& planes, uint64_t& timestamp, long timeoutMs);
     bool initializeSharedMemory();
     void cleanupSharedMemory();
 
     //Collsion detection
-    void checkCollision(uint64_t currentTime, std::vector<msg_plane_info> planes);
+    // predicted: dead-reckoned positions between frames, whose alerts carry no read stamp
+    void checkCollision(uint64_t currentTime, std::vector<msg_plane_info> planes, bool predicted = false);
     bool checkAxes(msg_plane_info plane1, msg_plane_info plane2);
+    static double closestApproach(const msg_plane_info& plane1, const msg_plane_info& plane2, double& tca);
     bool sameSpeed(double peed1, double speed2);
 
     //Handle messages from operator
     void processMessage();
-    void sendMessagesToComms(const Message& msg);
+    bool sendMessagesToComms(const Message& msg);
     void handleTimeConstraintChange(const Message& msg);
-    void sendCollisionToDisplay(const Message_inter_process& msg);
+    void sendCollisionToDisplay(const Message& msg);
+    void sendAlertSnapshot();
+    std::vector<int> resolveGroup(const msg_group_command& group);
 
     int timeConstraintCollisionFreq = 180;
 
+    // Conflict checks per second, on predicted positions between radar frames
+    int predictionRateHz = 10;
+    TrackPredictor predictor;
+
+    // Measurement-only timer (never armed) behind the monitoring loop's deadline monitor
+    ATCTimer monitorTimer{0, 0};
+    DeadlineMonitor monitorDeadline{"ComputerSystem::monitorAirspace", monitorTimer, 1000.0 / predictionRateHz};
+
+    // Conflict alert state; only transitions are sent to the Display
+    AlertManager alerts;
+    bool displayUnreachable = false;  // Last alert send failed; logged once until one succeeds
+    uint32_t alertSnapshots = 0;      // Numbers the ALERT_SNAPSHOT messages
+    uint64_t lastSnapshotTime = 0;    // TimeBase::nowNs() of the last one
+
+    // Pairs within the alert exit separation, found sector by sector
+    SectorDetector sectors;
+
+    // Sensor-to-alert tracing (see latency_trace); the Display records the remaining stages
+    uint64_t framePublishTime = 0;  // publish_time of the frame being processed
+    uint64_t frameReadTime = 0;     // When that frame was copied out of shared memory
+    LatencyHistogram pollLatency{"aircraft state -> radar poll"};
+    LatencyHistogram publishLatency{"radar poll -> publish"};
+    LatencyHistogram readLatency{"publish -> monitor read"};
+    LatencyHistogram detectLatency{"monitor read -> conflict check"};
+
+    // Command sequence numbers and command-to-effect latency
+    CommandTracker commandTracker;
+
+    // Long-lived connections to Display, CommunicationsSystem and aircraft
+    EndpointManager endpoints;
+
+    // Nearest-neighbour, radius and box queries over the frames (TRAFFIC_QUERY_CHANNEL)
+    TrafficQueryService traffic;
 
 
     int shm_fd;
@@ -56,6 +125,10 @@ private:
     std::thread monitorOperatorInput;
     std::atomic<bool> running;
 
+    // Publish notification bookkeeping (see SharedMemory::generation)
+    uint64_t lastGeneration = 0;  // Last frame generation processed
+    uint64_t skippedFrames = 0;   // Generations published but never processed
+
     bool listen = true;
 };
 
@@ -0,0 +1,136 @@
+#include "EndpointManager.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+
+EndpointManager::EndpointManager() {}
+
+EndpointManager::~EndpointManager() {
+	closeAll();
+}
+
+// Find (or create) the bookkeeping entry of a peer
+EndpointManager::Endpoint& EndpointManager::lookup(const std::string& name) {
+	std::lock_guard<std::mutex> guard(endpointsMutex);
+	std::unique_ptr<Endpoint>& ep = endpoints[name];
+	if (!ep) {
+		ep.reset(new Endpoint());
+		ep->stats.name = name;
+	}
+	return *ep;
+}
+
+// Resolve the peer name; caller holds ep.lock
+bool EndpointManager::connect(Endpoint& ep) {
+	if (!ep.connection.open(ep.stats.name)) {
+		int err = errno;
+		if (!ep.unreachable) {
+			std::cerr << "EndpointManager: open failed for '" << ep.stats.name
+			          << "': " << strerror(err) << "\n";
+		}
+		ep.unreachable = true;
+		errno = err;
+		return false;
+	}
+	ep.resolved = true;
+	ep.unreachable = false;
+	return true;
+}
+
+// Close the cached connection; caller holds ep.lock
+void EndpointManager::disconnect(Endpoint& ep) {
+	ep.connection.close();
+}
+
+bool EndpointManager::send(const std::string& name, const void* msg, size_t size, void* reply, size_t replySize) {
+	Endpoint& ep = lookup(name);
+	std::lock_guard<std::mutex> guard(ep.lock);
+
+	// Two attempts: the cached connection, then a fresh one if the peer went away
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		if (!ep.connection.isOpen()) {
+			if (ep.resolved) {
+				ep.stats.reconnects++;
+			}
+			if (!connect(ep)) {
+				break;
+			}
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		int rc = ep.connection.send(msg, size, reply, replySize);
+		auto end = std::chrono::steady_clock::now();
+
+		if (rc != -1) {
+			double latency = std::chrono::duration<double, std::milli>(end - start).count();
+			if (ep.stats.sends == 0 || latency < ep.stats.minLatencyMs) ep.stats.minLatencyMs = latency;
+			if (latency > ep.stats.maxLatencyMs) ep.stats.maxLatencyMs = latency;
+			ep.stats.totalLatencyMs += latency;
+			ep.stats.sends++;
+			return true;
+		}
+
+		int err = errno;
+		if (err == EBADF || err == ESRCH || err == ENOTCONN || err == ECONNREFUSED) {
+			// Connection is stale: drop it and retry once with a fresh connection
+			disconnect(ep);
+			continue;
+		}
+		// The peer answered with an error (e.g. EBUSY back-pressure): the connection is still good
+		std::cerr << "EndpointManager: send to '" << name << "' failed: " << strerror(err) << "\n";
+		ep.stats.failures++;
+		errno = err;
+		return false;
+	}
+
+	ep.stats.failures++;
+	return false;
+}
+
+void EndpointManager::release(const std::string& name) {
+	std::unique_lock<std::mutex> mapGuard(endpointsMutex);
+	auto it = endpoints.find(name);
+	if (it == endpoints.end()) {
+		return;
+	}
+	Endpoint& ep = *it->second;
+	mapGuard.unlock();
+
+	std::lock_guard<std::mutex> guard(ep.lock);
+	disconnect(ep);
+}
+
+void EndpointManager::closeAll() {
+	std::lock_guard<std::mutex> mapGuard(endpointsMutex);
+	for (auto& entry : endpoints) {
+		std::lock_guard<std::mutex> guard(entry.second->lock);
+		disconnect(*entry.second);
+	}
+}
+
+std::vector<EndpointStats> EndpointManager::getStats() {
+	std::vector<EndpointStats> snapshot;
+	std::lock_guard<std::mutex> mapGuard(endpointsMutex);
+	for (auto& entry : endpoints) {
+		std::lock_guard<std::mutex> guard(entry.second->lock);
+		snapshot.push_back(entry.second->stats);
+	}
+	return snapshot;
+}
+
+void EndpointManager::printStats() {
+	std::cout << "\n================= Endpoint Statistics =================\n";
+	std::cout << std::left << std::setw(28) << "Peer"
+	          << std::setw(8) << "Sends" << std::setw(8) << "Fails" << std::setw(8) << "Reconn"
+	          << "min/avg/max (ms)\n";
+	for (const EndpointStats& s : getStats()) {
+		double avg = s.sends ? s.totalLatencyMs / s.sends : 0.0;
+		std::cout << std::left << std::setw(28) << s.name
+		          << std::setw(8) << s.sends << std::setw(8) << s.failures << std::setw(8) << s.reconnects
+		          << std::fixed << std::setprecision(3)
+		          << s.minLatencyMs << "/" << avg << "/" << s.maxLatencyMs << "\n";
+		std::cout.unsetf(std::ios::fixed);
+	}
+}
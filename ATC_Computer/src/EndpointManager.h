@@ -0,0 +1,76 @@
+/*
+ * The EndpointManager class keeps one long-lived IpcConnection per named peer
+ * (Display, CommunicationsSystem, each aircraft channel, ...).
+ *
+ * *****Connection caching*****:
+ * The first send to a peer resolves its name with IpcConnection::open and
+ * caches the connection. Every later send reuses that connection instead of paying
+ * name resolution on the critical path.
+ *
+ * *****Reconnection*****:
+ * If a send fails because the peer went away (EBADF, ESRCH, ENOTCONN...)
+ * the cached connection is closed, the name is resolved again and the send
+ * is retried once.
+ *
+ * *****Statistics*****:
+ * Each peer keeps counters for sends, failures and reconnects together with
+ * min/avg/max send latency in milliseconds (see getStats / printStats).
+ */
+
+#ifndef ENDPOINTMANAGER_H_
+#define ENDPOINTMANAGER_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Ipc.h"
+
+struct EndpointStats {
+	std::string name;
+	uint64_t sends = 0;        // Successful sends
+	uint64_t failures = 0;     // Sends that failed even after reconnecting
+	uint64_t reconnects = 0;   // Times the name had to be resolved again
+	double minLatencyMs = 0.0;
+	double maxLatencyMs = 0.0;
+	double totalLatencyMs = 0.0;
+};
+
+class EndpointManager {
+public:
+	EndpointManager();
+	~EndpointManager();
+
+	// Send a message to the named peer, resolving/reconnecting as needed.
+	// Returns false if the message could not be delivered.
+	bool send(const std::string& name, const void* msg, size_t size, void* reply = nullptr, size_t replySize = 0);
+
+	// Drop the cached connection of a peer (e.g. an aircraft that left the airspace)
+	void release(const std::string& name);
+
+	// Close every cached connection
+	void closeAll();
+
+	std::vector<EndpointStats> getStats();
+	void printStats();
+
+private:
+	struct Endpoint {
+		IpcConnection connection;
+		bool resolved = false;  // Name was resolved at least once
+		bool unreachable = false;  // Last open failed; logged once until one succeeds
+		EndpointStats stats;
+		std::mutex lock;  // Serializes sends to this peer only
+	};
+
+	Endpoint& lookup(const std::string& name);
+	bool connect(Endpoint& ep);
+	void disconnect(Endpoint& ep);
+
+	std::map<std::string, std::unique_ptr<Endpoint>> endpoints;
+	std::mutex endpointsMutex;  // Protects the map itself, never held across a send
+};
+
+#endif /* ENDPOINTMANAGER_H_ */
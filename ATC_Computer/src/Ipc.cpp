@@ -0,0 +1,340 @@
+#include "Ipc.h"
+#include <cstring>
+#include <cstdint>
+
+#ifdef __QNX__
+
+#include <sys/neutrino.h>
+#include <sys/iomsg.h>
+
+IpcServer::IpcServer(const std::string& name) {
+	attach = name_attach(NULL, name.c_str(), 0);
+}
+
+IpcServer::~IpcServer() {
+	if (attach) {
+		name_detach(attach, 0);
+	}
+}
+
+bool IpcServer::isAttached() const {
+	return attach != nullptr;
+}
+
+int IpcServer::receive(void* msg, size_t size, size_t& received) {
+	if (!attach) {
+		errno = EBADF;
+		return -1;
+	}
+	while (true) {
+		struct _msg_info info;
+		int rcvid = MsgReceive(attach->chid, msg, size, &info);
+		if (rcvid == 0) {
+			continue;  // Pulse, e.g. a client disconnecting
+		}
+		uint16_t type = 0;
+		if (rcvid > 0 && size >= sizeof(type)) {
+			std::memcpy(&type, msg, sizeof(type));
+			if (type == _IO_CONNECT) {
+				MsgReply(rcvid, EOK, NULL, 0);  // Sent by name_open
+				continue;
+			}
+		}
+		if (rcvid > 0) {
+			received = info.srcmsglen;
+		}
+		return rcvid;
+	}
+}
+
+void IpcServer::detach() {
+	if (attach) {
+		name_attach_t* detaching = attach;
+		attach = nullptr;
+		name_detach(detaching, 0);  // Fails a blocked MsgReceive
+	}
+}
+
+int IpcServer::reply(int rcvid, int status, const void* msg, size_t size) {
+	return MsgReply(rcvid, status, msg, size);
+}
+
+int IpcServer::error(int rcvid, int err) {
+	return MsgError(rcvid, err);
+}
+
+IpcConnection::IpcConnection() {}
+
+IpcConnection::~IpcConnection() {
+	close();
+}
+
+bool IpcConnection::open(const std::string& name) {
+	close();
+	coid = name_open(name.c_str(), 0);
+	return coid != -1;
+}
+
+bool IpcConnection::isOpen() const {
+	return coid != -1;
+}
+
+void IpcConnection::close() {
+	if (coid != -1) {
+		name_close(coid);
+		coid = -1;
+	}
+}
+
+int IpcConnection::send(const void* msg, size_t size, void* reply, size_t replySize) {
+	return MsgSend(coid, msg, size, reply, replySize);
+}
+
+#else
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstddef>
+
+// Sent in front of every reply
+struct IpcReplyHeader {
+	int32_t status;
+	int32_t err;  // Non-zero for error()
+};
+
+// Abstract socket address (leading NUL) for a server name
+static socklen_t ipcAddress(const std::string& name, sockaddr_un& addr) {
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	std::string path = "atc/" + name;
+	size_t len = std::min(path.size(), sizeof(addr.sun_path) - 1);
+	std::memcpy(addr.sun_path + 1, path.data(), len);
+	return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + 1 + len);
+}
+
+static int sendReply(int fd, const IpcReplyHeader& header, const void* msg, size_t size) {
+	iovec iov[2];
+	iov[0].iov_base = const_cast<IpcReplyHeader*>(&header);
+	iov[0].iov_len = sizeof(header);
+	iov[1].iov_base = const_cast<void*>(msg);
+	iov[1].iov_len = size;
+	msghdr out;
+	std::memset(&out, 0, sizeof(out));
+	out.msg_iov = iov;
+	out.msg_iovlen = (msg && size) ? 2 : 1;
+	ssize_t n;
+	do {
+		n = sendmsg(fd, &out, MSG_NOSIGNAL);
+	} while (n == -1 && errno == EINTR);
+	return n == -1 ? -1 : 0;
+}
+
+IpcServer::IpcServer(const std::string& name) {
+	listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (listenFd == -1) {
+		return;
+	}
+	sockaddr_un addr;
+	socklen_t len = ipcAddress(name, addr);
+	if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), len) == -1 || listen(listenFd, SOMAXCONN) == -1) {
+		int err = errno;
+		::close(listenFd);
+		listenFd = -1;
+		errno = err;
+	}
+}
+
+IpcServer::~IpcServer() {
+	for (int fd : clients) {
+		::close(fd);
+	}
+	if (listenFd != -1) {
+		::close(listenFd);
+	}
+}
+
+bool IpcServer::isAttached() const {
+	return listenFd != -1 && !detached;
+}
+
+void IpcServer::detach() {
+	// The socket stays open until destruction so its descriptor cannot be reused under a blocked poll
+	if (listenFd != -1 && !detached.exchange(true)) {
+		::shutdown(listenFd, SHUT_RDWR);  // Wakes up a blocked poll
+	}
+}
+
+void IpcServer::dropClient(int fd) {
+	::close(fd);
+	clients.erase(std::remove(clients.begin(), clients.end(), fd), clients.end());
+	awaitingReply.erase(std::remove(awaitingReply.begin(), awaitingReply.end(), fd), awaitingReply.end());
+}
+
+int IpcServer::receive(void* msg, size_t size, size_t& received) {
+	std::vector<pollfd> fds;
+	while (true) {
+		if (!isAttached()) {
+			errno = EBADF;
+			return -1;
+		}
+		fds.clear();
+		fds.push_back(pollfd{listenFd, POLLIN, 0});
+		for (int fd : clients) {
+			if (std::find(awaitingReply.begin(), awaitingReply.end(), fd) == awaitingReply.end()) {
+				fds.push_back(pollfd{fd, POLLIN, 0});
+			}
+		}
+		if (poll(fds.data(), fds.size(), -1) == -1) {
+			return -1;
+		}
+
+		if (fds[0].revents & POLLIN) {
+			int fd = accept4(listenFd, NULL, NULL, SOCK_CLOEXEC);
+			if (fd != -1) {
+				clients.push_back(fd);
+			}
+		}
+
+		for (size_t i = 1; i < fds.size(); ++i) {
+			if (!fds[i].revents) {
+				continue;
+			}
+			int fd = fds[i].fd;
+			// MSG_TRUNC: the length of the whole packet, even if it did not fit
+			ssize_t n = recv(fd, msg, size, MSG_TRUNC);
+			if (n == -1 && errno == EINTR) {
+				continue;
+			}
+			if (n <= 0) {
+				dropClient(fd);  // Client closed its connection
+				continue;
+			}
+			// Served clients go to the back so a busy client cannot starve the others
+			clients.erase(std::remove(clients.begin(), clients.end(), fd), clients.end());
+			clients.push_back(fd);
+			awaitingReply.push_back(fd);
+			received = static_cast<size_t>(n);
+			return fd;
+		}
+	}
+}
+
+int IpcServer::reply(int rcvid, int status, const void* msg, size_t size) {
+	auto it = std::find(awaitingReply.begin(), awaitingReply.end(), rcvid);
+	if (it == awaitingReply.end()) {
+		errno = ESRCH;
+		return -1;
+	}
+	awaitingReply.erase(it);
+	if (sendReply(rcvid, IpcReplyHeader{status, 0}, msg, size) == -1) {
+		int err = errno;
+		dropClient(rcvid);
+		errno = err;
+		return -1;
+	}
+	return 0;
+}
+
+int IpcServer::error(int rcvid, int err) {
+	auto it = std::find(awaitingReply.begin(), awaitingReply.end(), rcvid);
+	if (it == awaitingReply.end()) {
+		errno = ESRCH;
+		return -1;
+	}
+	awaitingReply.erase(it);
+	if (sendReply(rcvid, IpcReplyHeader{-1, err}, nullptr, 0) == -1) {
+		int sendErr = errno;
+		dropClient(rcvid);
+		errno = sendErr;
+		return -1;
+	}
+	return 0;
+}
+
+IpcConnection::IpcConnection() {}
+
+IpcConnection::~IpcConnection() {
+	close();
+}
+
+bool IpcConnection::open(const std::string& name) {
+	close();
+	int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (fd == -1) {
+		return false;
+	}
+	sockaddr_un addr;
+	socklen_t len = ipcAddress(name, addr);
+	if (connect(fd, reinterpret_cast<sockaddr*>(&addr), len) == -1) {
+		int err = errno;
+		::close(fd);
+		errno = err;
+		return false;
+	}
+	coid = fd;
+	return true;
+}
+
+bool IpcConnection::isOpen() const {
+	return coid != -1;
+}
+
+void IpcConnection::close() {
+	if (coid != -1) {
+		::close(coid);
+		coid = -1;
+	}
+}
+
+int IpcConnection::send(const void* msg, size_t size, void* reply, size_t replySize) {
+	std::lock_guard<std::mutex> guard(sendMutex);
+	if (coid == -1) {
+		errno = EBADF;
+		return -1;
+	}
+
+	ssize_t n;
+	do {
+		n = ::send(coid, msg, size, MSG_NOSIGNAL);
+	} while (n == -1 && errno == EINTR);
+	if (n == -1) {
+		if (errno == EPIPE || errno == ECONNRESET) errno = ESRCH;
+		return -1;
+	}
+
+	IpcReplyHeader header;
+	iovec iov[2];
+	iov[0].iov_base = &header;
+	iov[0].iov_len = sizeof(header);
+	iov[1].iov_base = reply;
+	iov[1].iov_len = replySize;
+	msghdr in;
+	std::memset(&in, 0, sizeof(in));
+	in.msg_iov = iov;
+	in.msg_iovlen = (reply && replySize) ? 2 : 1;
+	do {
+		n = recvmsg(coid, &in, 0);
+	} while (n == -1 && errno == EINTR);
+	if (n == 0 || (n == -1 && errno == ECONNRESET)) {
+		errno = ESRCH;  // Server went away before replying
+		return -1;
+	}
+	if (n == -1) {
+		return -1;
+	}
+	if (static_cast<size_t>(n) < sizeof(header)) {
+		errno = EBADMSG;
+		return -1;
+	}
+	if (header.err) {
+		errno = header.err;
+		return -1;
+	}
+	return header.status;
+}
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * The IpcServer and IpcConnection classes wrap the synchronous message passing
+ * used between the ATC processes so the same code runs on QNX and on Linux.
+ *
+ * *****Semantics*****:
+ * They keep the QNX send/receive/reply model. A client send() blocks until
+ * the server replies to that message. The server receive()s one message at a
+ * time, identified by a receive id, and answers it with reply() or error().
+ * A message longer than the receive buffer is truncated; receive() reports
+ * the length that was sent, so the caller can tell.
+ *
+ *   IpcServer             QNX                    Linux
+ *   IpcServer(name)       name_attach            bind + listen
+ *   receive               MsgReceive             poll + recv
+ *   reply / error         MsgReply / MsgError    send of reply header + data
+ *
+ *   IpcConnection         QNX                    Linux
+ *   open(name)            name_open              connect
+ *   send                  MsgSend                send + recv of the reply
+ *   close                 name_close             close
+ *
+ * *****QNX backend*****:
+ * Used when __QNX__ is defined. receive() answers the _IO_CONNECT message sent
+ * by name_open and skips pulses, so callers only see application messages.
+ *
+ * *****Linux backend*****:
+ * Each name is a SOCK_SEQPACKET Unix domain socket in the abstract namespace
+ * ("atc/<name>"), so message boundaries are kept and nothing is left on disk.
+ * The receive id is the socket of the client. A client waiting for its reply
+ * is not polled, so a receive id stays valid until it is replied to.
+ * Replies carry a small header with the status (or the error of error()).
+ * A send to a server that went away fails with ESRCH, as on QNX.
+ * Only one thread should call receive() on a given server; detach() may be
+ * called from another thread to stop it.
+ *
+ * EOK is defined here for Linux.
+ */
+
+#ifndef IPC_H_
+#define IPC_H_
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <errno.h>
+
+#ifdef __QNX__
+#include <sys/dispatch.h>
+#endif
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+class IpcServer {
+public:
+	explicit IpcServer(const std::string& name);
+	~IpcServer();
+
+	IpcServer(const IpcServer&) = delete;
+	IpcServer& operator=(const IpcServer&) = delete;
+
+	// False if the name could not be registered (errno is set)
+	bool isAttached() const;
+
+	// Block for the next message; returns its receive id, or -1 with errno set.
+	// `received` is the length the client sent, larger than size if truncated.
+	int receive(void* msg, size_t size, size_t& received);
+
+	// Unregister the name; a blocked or later receive() returns -1 (EBADF)
+	void detach();
+
+	// Unblock the sender of `rcvid` with a status and reply data
+	int reply(int rcvid, int status, const void* msg = nullptr, size_t size = 0);
+
+	// Unblock the sender of `rcvid`, making its send() fail with `err`
+	int error(int rcvid, int err);
+
+private:
+#ifdef __QNX__
+	name_attach_t* attach = nullptr;
+#else
+	int listenFd = -1;
+	std::atomic<bool> detached{false};
+	std::vector<int> clients;          // Connected clients
+	std::vector<int> awaitingReply;    // Clients blocked in send()
+	void dropClient(int fd);
+#endif
+};
+
+class IpcConnection {
+public:
+	IpcConnection();
+	~IpcConnection();
+
+	IpcConnection(const IpcConnection&) = delete;
+	IpcConnection& operator=(const IpcConnection&) = delete;
+
+	// Connect to a named server; returns false with errno set if it does not exist
+	bool open(const std::string& name);
+	bool isOpen() const;
+	void close();
+
+	// Send a message and block for the reply.
+	// Returns the status given to reply(), or -1 with errno set.
+	int send(const void* msg, size_t size, void* reply = nullptr, size_t replySize = 0);
+
+private:
+	int coid = -1;
+#ifndef __QNX__
+	std::mutex sendMutex;  // One request in flight per socket
+#endif
+};
+
+#endif /* IPC_H_ */
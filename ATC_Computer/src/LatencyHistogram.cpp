@@ -0,0 +1,88 @@
+#include "LatencyHistogram.h"
+#include <iomanip>
+
+LatencyHistogram::LatencyHistogram(const std::string& name) : name(name), total(0), maxValue(0) {
+	counts.fill(0);
+}
+
+int LatencyHistogram::bucketFor(uint64_t ns) {
+	if (ns < SUB_BUCKETS) {
+		return static_cast<int>(ns);  // Exact buckets for tiny values
+	}
+	int msb = 63 - __builtin_clzll(ns);
+	int shift = msb - 4;
+	int sub = static_cast<int>((ns >> shift) & (SUB_BUCKETS - 1));
+	return (msb - 3) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int bucket) {
+	if (bucket < SUB_BUCKETS) {
+		return bucket;
+	}
+	int msb = bucket / SUB_BUCKETS + 3;
+	int sub = bucket % SUB_BUCKETS;
+	uint64_t lower = (uint64_t)(SUB_BUCKETS + sub) << (msb - 4);
+	return lower + ((uint64_t)1 << (msb - 4)) - 1;
+}
+
+void LatencyHistogram::recordInterval(uint64_t startNs, uint64_t endNs) {
+	if (startNs == 0 || endNs == 0) {
+		return;
+	}
+	record(endNs > startNs ? endNs - startNs : 0);
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+	std::lock_guard<std::mutex> guard(lock);
+	counts[bucketFor(ns)]++;
+	total++;
+	if (ns > maxValue) maxValue = ns;
+}
+
+uint64_t LatencyHistogram::count() {
+	std::lock_guard<std::mutex> guard(lock);
+	return total;
+}
+
+uint64_t LatencyHistogram::max() {
+	std::lock_guard<std::mutex> guard(lock);
+	return maxValue;
+}
+
+uint64_t LatencyHistogram::percentile(double p) {
+	std::lock_guard<std::mutex> guard(lock);
+	return percentileLocked(p);
+}
+
+uint64_t LatencyHistogram::percentileLocked(double p) {
+	if (total == 0) {
+		return 0;
+	}
+	uint64_t rank = static_cast<uint64_t>(p / 100.0 * total + 0.5);
+	if (rank < 1) rank = 1;
+	uint64_t seen = 0;
+	for (int i = 0; i < BUCKETS; ++i) {
+		seen += counts[i];
+		if (seen >= rank) {
+			uint64_t bound = bucketUpperBound(i);
+			return bound < maxValue ? bound : maxValue;
+		}
+	}
+	return maxValue;
+}
+
+void LatencyHistogram::printHeader(std::ostream& out) {
+	out << std::left << std::setw(36) << "Stage" << std::right
+	    << std::setw(10) << "count" << std::setw(12) << "p50 (us)"
+	    << std::setw(12) << "p99 (us)" << std::setw(12) << "max (us)" << "\n";
+}
+
+void LatencyHistogram::print(std::ostream& out) {
+	std::lock_guard<std::mutex> guard(lock);
+	out << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(1)
+	    << std::setw(10) << total
+	    << std::setw(12) << percentileLocked(50.0) / 1000.0
+	    << std::setw(12) << percentileLocked(99.0) / 1000.0
+	    << std::setw(12) << maxValue / 1000.0 << "\n";
+	out.unsetf(std::ios::fixed);
+}
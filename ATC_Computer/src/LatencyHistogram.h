@@ -0,0 +1,51 @@
+/*
+ * The LatencyHistogram class records latency samples (nanoseconds) for one
+ * stage of the sensor-to-alert pipeline.
+ *
+ * Samples go into log-linear buckets: every power of two is split into 16
+ * sub-buckets, so any reported percentile is within ~6% of the true value
+ * while recording stays O(1) with a fixed memory footprint.
+ *
+ * print() reports count, p50, p99 and max in microseconds.
+ */
+
+#ifndef LATENCYHISTOGRAM_H_
+#define LATENCYHISTOGRAM_H_
+
+#include <array>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+class LatencyHistogram {
+public:
+	LatencyHistogram(const std::string& name);
+
+	// Record the latency between two monotonic timestamps; ignored if either is missing
+	void recordInterval(uint64_t startNs, uint64_t endNs);
+	void record(uint64_t ns);
+
+	uint64_t count();
+	uint64_t percentile(double p);  // ns, upper bound of the bucket holding the percentile
+	uint64_t max();
+
+	static void printHeader(std::ostream& out);
+	void print(std::ostream& out);
+
+private:
+	static const int SUB_BUCKETS = 16;
+	static const int BUCKETS = 64 * SUB_BUCKETS;
+
+	static int bucketFor(uint64_t ns);
+	static uint64_t bucketUpperBound(int bucket);
+	uint64_t percentileLocked(double p);
+
+	std::string name;
+	std::array<uint64_t, BUCKETS> counts;
+	uint64_t total;
+	uint64_t maxValue;
+	std::mutex lock;
+};
+
+#endif /* LATENCYHISTOGRAM_H_ */
@@ -0,0 +1,167 @@
+#include "MemoryWarmup.h"
+#include <mutex>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <alloca.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+
+std::mutex reportMutex;
+MemoryReport report;
+
+size_t pageSize() {
+	static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	return size;
+}
+
+// Touch one byte per page. A writable shared page is faulted in for writing
+// with an atomic no-op, so a concurrent writer in another process is not disturbed.
+void touch(void* addr, size_t size, bool write) {
+	volatile char* bytes = static_cast<volatile char*>(addr);
+	for (size_t offset = 0; offset < size; offset += pageSize()) {
+		if (write) {
+			__atomic_fetch_or(const_cast<char*>(bytes + offset), 0, __ATOMIC_RELAXED);
+		} else {
+			(void)bytes[offset];
+		}
+	}
+}
+
+// mlock() wants a page-aligned range
+void lockRange(void* addr, size_t size) {
+	uintptr_t first = reinterpret_cast<uintptr_t>(addr) & ~(uintptr_t)(pageSize() - 1);
+	uintptr_t end = reinterpret_cast<uintptr_t>(addr) + size;
+	mlock(reinterpret_cast<void*>(first), end - first);  // Best effort: already locked by mlockall if permitted
+}
+
+} // namespace
+
+bool MemoryWarmup::lockProcessMemory() {
+#ifdef __GLIBC__
+	// Freed heap memory stays mapped (and locked) for the next allocation
+	mallopt(M_TRIM_THRESHOLD, -1);
+	mallopt(M_MMAP_MAX, 0);
+	mallopt(M_ARENA_MAX, 1);  // Threads allocate from the heap pre-faulted below
+#endif
+	bool locked = mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#ifdef MCL_ONFAULT
+	// What is resident now stays so; new mappings (thread stacks) are locked page by page as used
+	if (locked) {
+		mlockall(MCL_CURRENT | MCL_FUTURE | MCL_ONFAULT);
+	}
+#endif
+	int lockErrno = errno;
+
+	// Grow the heap once: later allocations reuse these resident pages
+	volatile char* heap = static_cast<volatile char*>(std::malloc(HEAP_PREFAULT_SIZE));
+	if (heap) {
+		for (size_t offset = 0; offset < HEAP_PREFAULT_SIZE; offset += pageSize()) {
+			heap[offset] = 0;  // Written, not just read: a read would only map the shared zero page
+		}
+		std::free(const_cast<char*>(heap));
+		countPrefaulted(HEAP_PREFAULT_SIZE);
+	}
+
+	std::lock_guard<std::mutex> lock(reportMutex);
+	report.locked = locked;
+	report.lockFailure = locked ? "" : strerror(lockErrno);
+	if (!locked) {
+		std::cerr << "MemoryWarmup: mlockall failed (" << report.lockFailure << "), memory can be paged out\n";
+	}
+	return locked;
+}
+
+bool MemoryWarmup::sizeShared(int fd, size_t size) {
+#if defined(__QNX__) && defined(SHMCTL_PHYS)
+	// Physically contiguous memory can be mapped with large pages
+	if (shm_ctl(fd, SHMCTL_ANON | SHMCTL_PHYS, 0, size) == 0) {
+		std::lock_guard<std::mutex> lock(reportMutex);
+		report.hugePageSegments++;
+		return true;
+	}
+#endif
+	return ftruncate(fd, size) == 0;
+}
+
+void* MemoryWarmup::mapShared(int fd, size_t size, int prot) {
+	void* mem = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+	if (mem == MAP_FAILED) {
+		return mem;
+	}
+	bool huge = false;
+#if defined(MADV_HUGEPAGE)
+	// Before the first touch, so that the pages are allocated huge
+	if (size >= HUGE_PAGE_SIZE) {
+		huge = madvise(mem, size, MADV_HUGEPAGE) == 0;
+	}
+#endif
+	lockRange(mem, size);
+	touch(mem, size, (prot & PROT_WRITE) != 0);
+
+	std::lock_guard<std::mutex> lock(reportMutex);
+	report.segments++;
+	if (huge) report.hugePageSegments++;
+	report.prefaultedBytes += size;
+	return mem;
+}
+
+void MemoryWarmup::prefault(void* addr, size_t size) {
+	lockRange(addr, size);
+	touch(addr, size, false);
+	countPrefaulted(size);
+}
+
+void MemoryWarmup::prefaultStack(size_t bytes) {
+	// A frame of `bytes` below the caller, written once so every page of it is mapped
+	volatile char* frame = static_cast<volatile char*>(alloca(bytes));
+	for (size_t offset = 0; offset < bytes; offset += pageSize()) {
+		frame[offset] = 0;
+	}
+	countPrefaulted(bytes);
+}
+
+long MemoryWarmup::pageFaults() {
+	struct rusage usage;
+#ifdef RUSAGE_THREAD
+	int who = RUSAGE_THREAD;
+#else
+	int who = RUSAGE_SELF;
+#endif
+	if (getrusage(who, &usage) == -1) {
+		return -1;
+	}
+	return usage.ru_minflt + usage.ru_majflt;
+}
+
+void MemoryWarmup::countPrefaulted(size_t bytes) {
+	std::lock_guard<std::mutex> lock(reportMutex);
+	report.prefaultedBytes += bytes;
+}
+
+MemoryReport MemoryWarmup::getReport() {
+	std::lock_guard<std::mutex> lock(reportMutex);
+	MemoryReport result = report;
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		result.minorFaults = usage.ru_minflt;
+		result.majorFaults = usage.ru_majflt;
+	}
+	return result;
+}
+
+void MemoryWarmup::printReport(std::ostream& os) {
+	MemoryReport r = getReport();
+	os << "\n================= Memory =================\n"
+	   << "Process memory locked: " << (r.locked ? "yes" : "no (" + r.lockFailure + ")") << "\n"
+	   << "Pre-faulted: " << r.prefaultedBytes / 1024 << " kB, " << r.segments << " shared segments ("
+	   << r.hugePageSegments << " on huge pages)\n"
+	   << "Page faults of the process: " << r.minorFaults << " minor, " << r.majorFaults << " major\n";
+}
@@ -1,8 +1,14 @@
 #pragma once
 #include <atomic>
 #include <array>
+#include <cstdint>
+#include <pthread.h>
+#include <time.h>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
 
-enum class MessageType {
+enum class MessageType : uint16_t {
     ENTER_AIRSPACE,
     EXIT_AIRSPACE,
     POSITION_UPDATE,
@@ -13,20 +19,38 @@ enum class MessageType {
 	REQUEST_AUGMENTED_INFO,
 	CHANGE_TIME_CONSTRAINT_COLLISIONS,
 	EXIT,
-	COLLISION_DETECTED
+	COLLISION_DETECTED,
+	REQUEST_LATENCY_REPORT,
+	REQUEST_GROUP_COMMAND,
+	REQUEST_TRAFFIC_QUERY,
+	ALERT_SNAPSHOT
 };
 
-struct Message {
-    bool header; //intra process; 1: interprocess
-	MessageType type;
-    int planeID;
-    void* data;  // Pointer to the message data
-    size_t dataSize;  // Size of the serialized data
-};
+// Monotonic clock shared by every ATC process on the node, used for latency tracing
+// (the clock of the shared time base, see SharedTimeBase)
+inline uint64_t monotonic_now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Pipeline timestamps (monotonic_now_ns) carried from the aircraft state to the Display.
+// A zero stamp means the stage was not traced.
+typedef struct {
+	uint64_t state;    // Aircraft produced the position
+	uint64_t poll;     // Radar received it
+	uint64_t publish;  // Frame written to shared memory
+	uint64_t read;     // ComputerSystem copied the frame
+	uint64_t detect;   // Conflict check finished
+	uint64_t send;     // Alert handed to the IPC send
+} latency_trace;
 
 typedef struct {
 	int id;
 	double PositionX, PositionY, PositionZ, VelocityX, VelocityY, VelocityZ;
+	uint64_t stateTime;  // When the aircraft produced this state (monotonic ns)
+	uint64_t pollTime;   // When the Radar received it (monotonic ns)
+	uint32_t commandSeq; // Sequence number of the last operator command applied by the aircraft
 } msg_plane_info;
 
 typedef struct {
@@ -39,20 +63,224 @@ typedef struct {
 	double x,y,z;
 } msg_change_position;
 
+// How a group command picks its aircraft
+enum class GroupSelector {
+	ID_LIST,        // ids[0..count)
+	BOX,            // minX..maxX, minY..maxY, minZ..maxZ
+	ALTITUDE_BAND   // minZ..maxZ
+};
+
+#define MAX_GROUP_IDS 32
+
+// Payload of REQUEST_GROUP_COMMAND: one command fanned out to every selected aircraft
+typedef struct {
+	MessageType command;           // REQUEST_CHANGE_OF_HEADING, _POSITION or _ALTITUDE
+	GroupSelector selector;
+	msg_change_heading heading;    // For heading and altitude commands
+	msg_change_position position;  // For position commands
+	double minX, maxX, minY, maxY, minZ, maxZ;
+	int count;
+	int ids[MAX_GROUP_IDS];
+} msg_group_command;
+
+// Aggregate acknowledgement of a group command
+typedef struct {
+	int matched;  // Aircraft selected in the current frame
+	int queued;   // Commands accepted by the CommunicationsSystem queue
+	int refused;  // Commands refused (queue full or not delivered to CommunicationsSystem)
+	uint32_t refusedMask;  // From CommunicationsSystem: bit i set if ids[i] of the batch was refused
+} msg_group_ack;
+
+static_assert(MAX_GROUP_IDS <= 32, "refusedMask holds one bit per aircraft of a batch");
+
+// What a traffic query selects over the current frame
+enum class TrafficQueryKind : uint8_t {
+	NEAREST,  // k aircraft closest to the centre
+	RADIUS,   // Aircraft within radius of the centre
+	BOX       // Aircraft inside minX..maxX, minY..maxY, minZ..maxZ
+};
+
+#define TRAFFIC_QUERY_MAX_MATCHES 64
+
+// Payload of REQUEST_TRAFFIC_QUERY
+typedef struct {
+	TrafficQueryKind kind;
+	int planeID;     // Centre on this aircraft (left out of the answer), or -1 to centre on x, y, z
+	double x, y, z;
+	int k;           // NEAREST
+	double radius;   // RADIUS (meters)
+	double minX, maxX, minY, maxY, minZ, maxZ;  // BOX
+} msg_traffic_query;
+
+typedef struct {
+	int id;
+	double distance;  // meters from the centre; 0 for BOX
+	double x, y, z;
+} msg_traffic_match;
+
+// Reply to REQUEST_TRAFFIC_QUERY, nearest first (BOX: by ID)
+typedef struct {
+	uint64_t generation;  // Frame the answer was computed on
+	uint64_t serviceNs;   // Receive to reply in the query service
+	int total;            // Aircraft matched; the first TRAFFIC_QUERY_MAX_MATCHES are listed
+	int count;
+	msg_traffic_match matches[TRAFFIC_QUERY_MAX_MATCHES];
+} msg_traffic_reply;
+
+// Conflict alert lifecycle, reported with COLLISION_DETECTED messages
+enum class AlertState {
+	NEW,        // Pair just crossed the entry threshold
+	ONGOING,    // Still in conflict, nothing changed (not sent to the Display)
+	ESCALATED,  // Closest approach is now imminent
+	CLEARED     // Pair separated past the exit threshold, or left the airspace
+};
+
+typedef struct {
+	int plane1, plane2;
+	AlertState state;
+	double timeToClosestApproach;  // seconds
+	double missDistance;           // meters at closest approach
+	latency_trace trace;           // Oldest aircraft state behind this alert, stage by stage
+} msg_collision_alert;
+
+// One active alert listed by an ALERT_SNAPSHOT
+typedef struct {
+	int plane1, plane2;
+	AlertState state;  // NEW, ONGOING or ESCALATED
+} msg_alert_entry;
+
+#define ALERT_SNAPSHOT_PART_ALERTS 20
+
+// Payload of ALERT_SNAPSHOT: the full set of active alerts, resent periodically so that
+// a Display that started late or missed transitions converges. Large sets span parts.
+typedef struct {
+	uint32_t snapshot;  // Same in every part of one snapshot
+	uint16_t part;      // 0 .. parts - 1, sent in order
+	uint16_t parts;
+	int count;          // Entries used in alerts[]
+	msg_alert_entry alerts[ALERT_SNAPSHOT_PART_ALERTS];
+} msg_alert_snapshot;
+
 // Shared memory structure
+#define SHARED_MEMORY_MAX_PLANES 100  // Capacity of one frame
+
 struct SharedMemory {
-    msg_plane_info plane_data[100];
+    msg_plane_info plane_data[SHARED_MEMORY_MAX_PLANES];
     int count;  // Keep track of the number of planes in the buffer
     std::atomic<bool> is_empty;  // New flag to indicate if there are no planes in the buffer
     bool start;
-    uint64_t timestamp;  // Timestamp of the last write
+    uint64_t timestamp;  // Simulation tick (SharedTimeBase::tick) at which the frame was completed
+    uint64_t publish_time;  // monotonic_now_ns() of the last write
+
+    // Publish notification: Lab4's TrackFusion writes the frame, bumps generation
+    // and broadcasts frame_cond, all under frame_mutex. Readers wait for a
+    // generation newer than the last one they processed and copy the frame out
+    // under the same mutex, so the writer and the readers wait for each other's copy.
+    pthread_mutex_t frame_mutex;  // process-shared
+    pthread_cond_t frame_cond;    // process-shared, CLOCK_MONOTONIC
+    uint64_t generation;          // Number of frames published so far
+};
+
+#define TIME_BASE_SHM_NAME "/atc_time"
+
+// Simulation time base, created by Lab4 and read lock-free by every process (see TimeBase)
+struct SharedTimeBase {
+    std::atomic<uint64_t> epoch_ns;        // monotonic_now_ns() at tick 0; 0 until initialized
+    std::atomic<uint64_t> tick_period_ns;  // Length of one simulation tick
+    std::atomic<uint64_t> tick;            // Simulation ticks elapsed since the epoch
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the time base is read with plain atomic loads");
+
+// Delivery class of operator commands in the CommunicationsSystem queue
+enum class CommandPriority : uint8_t {
+	ROUTINE = 0,              // Default for zero-initialized messages
+	SEPARATION_CRITICAL = 1   // Command for a plane involved in an active conflict alert
 };
 
-struct Message_inter_process {
-	bool header; //intra process; 1: interprocess
+// Wire format shared by every process: a fixed MessageHeader followed by
+// header.length bytes of inline payload, sent as exactly size() bytes.
+// Bump ATC_WIRE_VERSION on any change to the header or to a payload struct.
+#define ATC_WIRE_MAGIC 0x4154  // "TA"; never matches the QNX _IO_CONNECT type (0x100)
+#define ATC_WIRE_VERSION 4
+#define MAX_PAYLOAD_SIZE 256
+
+struct MessageHeader {
+	uint16_t magic;            // ATC_WIRE_MAGIC
+	uint8_t version;           // ATC_WIRE_VERSION
+	CommandPriority priority;  // Set by ComputerSystem when forwarding commands
 	MessageType type;
-    int planeID;
-    std::array<char, 256> data;  // Pointer to the message data
-    size_t dataSize;  // Size of the serialized data
+	uint16_t length;           // Payload bytes following the header
+	int32_t planeID;
+	uint32_t sequence;         // Command sequence number assigned by ComputerSystem, echoed in msg_plane_info
+	uint64_t timestamp;        // monotonic_now_ns() when the message was built
 };
 
+static_assert(sizeof(MessageHeader) == 24, "MessageHeader layout is part of the wire format");
+
+// A message is built and parsed in place: init() writes the header, put<T>()
+// hands out the payload to fill, get<T>() views a received payload as T.
+// Receive into a whole Message; send only its first size() bytes.
+struct Message {
+	MessageHeader header;
+	alignas(8) unsigned char payload[MAX_PAYLOAD_SIZE];
+
+	void init(MessageType type, int planeID = -1) {
+		header.magic = ATC_WIRE_MAGIC;
+		header.version = ATC_WIRE_VERSION;
+		header.priority = CommandPriority::ROUTINE;
+		header.type = type;
+		header.length = 0;
+		header.planeID = planeID;
+		header.sequence = 0;
+		header.timestamp = monotonic_now_ns();
+	}
+
+	// Reserve `count` zeroed T's of payload; nullptr if they do not fit
+	template <typename T>
+	T* put(size_t count = 1) {
+		static_assert(std::is_trivially_copyable<T>::value, "payloads are sent as raw bytes");
+		if (count * sizeof(T) > MAX_PAYLOAD_SIZE) {
+			return nullptr;
+		}
+		header.length = static_cast<uint16_t>(count * sizeof(T));
+		std::memset(payload, 0, header.length);
+		return reinterpret_cast<T*>(payload);
+	}
+
+	// Typed view of the payload; nullptr unless it holds at least one whole T
+	template <typename T>
+	const T* get() const {
+		return header.length >= sizeof(T) ? reinterpret_cast<const T*>(payload) : nullptr;
+	}
+
+	// Number of whole T's in the payload
+	template <typename T>
+	size_t count() const {
+		return header.length / sizeof(T);
+	}
+
+	// Bytes on the wire: header plus the exact payload
+	size_t size() const {
+		return sizeof(MessageHeader) + header.length;
+	}
+
+	// Header checks only: for replies, whose length the sender does not learn
+	bool valid() const {
+		return header.magic == ATC_WIRE_MAGIC && header.version == ATC_WIRE_VERSION
+		    && header.length <= MAX_PAYLOAD_SIZE;
+	}
+
+	// Header checks for a received message, which must be exactly size() bytes
+	// (`received` as reported by IpcServer::receive)
+	bool valid(size_t received) const {
+		return valid() && received == size();
+	}
+};
+
+// Largest number of T's carried by one message
+#define PAYLOAD_CAPACITY(T) (MAX_PAYLOAD_SIZE / sizeof(T))
+
+static_assert(sizeof(msg_group_command) <= MAX_PAYLOAD_SIZE, "group command must fit in one message");
+static_assert(sizeof(msg_traffic_query) <= MAX_PAYLOAD_SIZE, "traffic query must fit in one message");
+static_assert(sizeof(msg_alert_snapshot) <= MAX_PAYLOAD_SIZE, "alert snapshot part must fit in one message");
@@ -1,157 +1,470 @@
-#include <iostream>
-#include <string>
-#include <cstring>
-#include <cerrno>
-#include <sys/dispatch.h>
-#include <unistd.h>
-#include "Msg_structs.h"
-#include "OperatorConsole.h"
-
-static constexpr const char* COMPUTER_SYSTEM_CHANNEL = "computer_system_channel";
-
-OperatorConsole::OperatorConsole(CommunicationsSystem& comms)
-    : commsRef(comms) {}
-
-
-OperatorConsole::~OperatorConsole() {
-    std::cout << "OperatorConsole destroyed.\n";
-}
-
-void OperatorConsole::start() {
-    std::cout << "Operator Console starting...\n";
-
-    // Open connection to ComputerSystem (name_open)
-    int coid = name_open(COMPUTER_SYSTEM_CHANNEL, 0);
-    if (coid == -1) {
-        std::cerr << "OperatorConsole: name_open failed for '" << COMPUTER_SYSTEM_CHANNEL
-                  << "': " << strerror(errno) << "\n";
-        return;
-    }
-
-    bool done = false;
-    while (!done) {
-        std::cout << "\nOperator Menu:\n"
-                  << " 1) Change aircraft speed (send velocity vector)\n"
-                  << " 2) Change aircraft position (teleport)\n"
-                  << " 3) Change aircraft altitude (via heading struct altitude field)\n"
-                  << " 4) Change collision-check frequency (ComputerSystem)\n"
-                  << " 0) Exit\n"
-                  << "Choose: ";
-        int choice;
-        if (!(std::cin >> choice)) {
-            std::cin.clear();
-            std::cin.ignore(1024, '\n');
-            continue;
-        }
-
-        if (choice == 0) {
-            done = true;
-            break;
-        }
-
-        Message_inter_process msg {};
-        msg.header = true; // inter-process
-        msg.dataSize = 0;
-        msg.planeID = -1;
-
-        switch (choice) {
-            case 1: {
-                // Change speed / velocity: use msg_change_heading
-                msg.type = MessageType::REQUEST_CHANGE_OF_HEADING;
-                std::cout << "Enter Aircraft ID: \n";
-                int id; std::cin >> id; msg.planeID = id;
-
-                msg_change_heading ch {};
-                std::cout << "Enter new VelocityX: \n"; std::cin >> ch.VelocityX;
-                std::cout << "Enter new VelocityY: \n"; std::cin >> ch.VelocityY;
-                std::cout << "Enter new VelocityZ: \n"; std::cin >> ch.VelocityZ;
-                std::cout << "Enter altitude: \n"; std::cin >> ch.altitude;
-                ch.ID = msg.planeID;
-
-                if (sizeof(ch) <= msg.data.size()) {
-                    std::memcpy(msg.data.data(), &ch, sizeof(ch));
-                    msg.dataSize = sizeof(ch);
-                } else {
-                    std::cerr << "OperatorConsole: payload too large\n";
-                    continue;
-                }
-                break;
-            }
-            case 2: {
-                // Change position: use msg_change_position
-                msg.type = MessageType::REQUEST_CHANGE_POSITION;
-                std::cout << "Enter Aircraft ID: \n";
-                int id; std::cin >> id; msg.planeID = id;
-
-                msg_change_position cp {};
-                std::cout << "Enter X: \n"; std::cin >> cp.x;
-                std::cout << "Enter Y: \n"; std::cin >> cp.y;
-                std::cout << "Enter Z: \n"; std::cin >> cp.z;
-
-                if (sizeof(cp) <= msg.data.size()) {
-                    std::memcpy(msg.data.data(), &cp, sizeof(cp));
-                    msg.dataSize = sizeof(cp);
-                } else {
-                    std::cerr << "OperatorConsole: payload too large\n";
-                    continue;
-                }
-                break;
-            }
-            case 3: {
-                // Change altitude — reuse msg_change_heading.altitude
-                msg.type = MessageType::REQUEST_CHANGE_ALTITUDE;
-                std::cout << "Enter Aircraft ID: \n";
-                int id; std::cin >> id; msg.planeID = id;
-
-                msg_change_heading ch {};
-                ch.ID = msg.planeID;
-                ch.altitude = 0.0;
-                std::cout << "Enter new altitude: \n";
-                std::cin >> ch.altitude;
-
-                if (sizeof(ch) <= msg.data.size()) {
-                    std::memcpy(msg.data.data(), &ch, sizeof(ch));
-                    msg.dataSize = sizeof(ch);
-                } else {
-                    std::cerr << "OperatorConsole: payload too large\n";
-                    continue;
-                }
-                break;
-            }
-            case 4: {
-                // Change collision-check frequency in ComputerSystem
-                msg.type = MessageType::CHANGE_TIME_CONSTRAINT_COLLISIONS;
-                std::cout << "Enter new collision time constraint (seconds): \n";
-                int freq; std::cin >> freq;
-                // We'll pack the integer into the data buffer
-                if (sizeof(int) <= msg.data.size()) {
-                    std::memcpy(msg.data.data(), &freq, sizeof(int));
-                    msg.dataSize = sizeof(int);
-                } else {
-                    std::cerr << "OperatorConsole: payload too large\n";
-                    continue;
-                }
-                break;
-            }
-            default:
-                std::cout << "Unknown choice\n";
-                continue;
-        }
-
-        // Send the message to ComputerSystem
-        int rc = MsgSend(coid, &msg, sizeof(msg), nullptr, 0);
-        if (rc == -1) {
-            std::cerr << "OperatorConsole: MsgSend failed: " << strerror(errno) << "\n";
-        } else {
-            std::cout << "Command sent.\n";
-        }
-
-        // small pause to allow processing
-        usleep(100000);
-    }
-
-    name_close(coid);
-    std::cout << "Operator Console exiting.\n";
-    return;
-}
-
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <unistd.h>
+#include "Msg_structs.h"
+#include "OperatorConsole.h"
+#include "LatencyHistogram.h"
+#include "Ipc.h"
+#include "TimeBase.h"
+#include "ThreadProfile.h"
+#include "TrafficQueryService.h"
+
+static constexpr const char* COMPUTER_SYSTEM_CHANNEL = "computer_system_channel";
+
+OperatorConsole::OperatorConsole(CommunicationsSystem& comms)
+    : commsRef(comms) {}
+
+
+OperatorConsole::~OperatorConsole() {
+    std::cout << "OperatorConsole destroyed.\n";
+}
+
+void OperatorConsole::start() {
+    std::cout << "Operator Console starting...\n";
+
+    // Open connection to ComputerSystem
+    IpcConnection computerSystem;
+    if (!computerSystem.open(COMPUTER_SYSTEM_CHANNEL)) {
+        std::cerr << "OperatorConsole: open failed for '" << COMPUTER_SYSTEM_CHANNEL
+                  << "': " << strerror(errno) << "\n";
+        return;
+    }
+
+    IpcConnection trafficService;
+
+    bool done = false;
+    while (!done) {
+        std::cout << "\nOperator Menu:\n"
+                  << " 1) Change aircraft speed (send velocity vector)\n"
+                  << " 2) Change aircraft position (teleport)\n"
+                  << " 3) Change aircraft altitude (via heading struct altitude field)\n"
+                  << " 4) Change collision-check frequency (ComputerSystem)\n"
+                  << " 5) Print pipeline latency report (ComputerSystem)\n"
+                  << " 6) Group command (ID list, box or altitude band)\n"
+                  << " 7) Nearest aircraft to an aircraft (traffic query)\n"
+                  << " 8) Aircraft within a radius of an aircraft (traffic query)\n"
+                  << " 9) Aircraft in a box (traffic query)\n"
+                  << " 0) Exit\n"
+                  << "Choose: ";
+        int choice;
+        if (!(std::cin >> choice)) {
+            std::cin.clear();
+            std::cin.ignore(1024, '\n');
+            continue;
+        }
+
+        if (choice == 0) {
+            done = true;
+            break;
+        }
+
+        Message msg;
+
+        switch (choice) {
+            case 1: {
+                // Change speed / velocity: use msg_change_heading
+                std::cout << "Enter Aircraft ID: \n";
+                int id; std::cin >> id;
+                msg.init(MessageType::REQUEST_CHANGE_OF_HEADING, id);
+
+                msg_change_heading& ch = *msg.put<msg_change_heading>();
+                std::cout << "Enter new VelocityX: \n"; std::cin >> ch.VelocityX;
+                std::cout << "Enter new VelocityY: \n"; std::cin >> ch.VelocityY;
+                std::cout << "Enter new VelocityZ: \n"; std::cin >> ch.VelocityZ;
+                std::cout << "Enter altitude: \n"; std::cin >> ch.altitude;
+                ch.ID = id;
+                break;
+            }
+            case 2: {
+                // Change position: use msg_change_position
+                std::cout << "Enter Aircraft ID: \n";
+                int id; std::cin >> id;
+                msg.init(MessageType::REQUEST_CHANGE_POSITION, id);
+
+                msg_change_position& cp = *msg.put<msg_change_position>();
+                std::cout << "Enter X: \n"; std::cin >> cp.x;
+                std::cout << "Enter Y: \n"; std::cin >> cp.y;
+                std::cout << "Enter Z: \n"; std::cin >> cp.z;
+                break;
+            }
+            case 3: {
+                // Change altitude — reuse msg_change_heading.altitude
+                std::cout << "Enter Aircraft ID: \n";
+                int id; std::cin >> id;
+                msg.init(MessageType::REQUEST_CHANGE_ALTITUDE, id);
+
+                msg_change_heading& ch = *msg.put<msg_change_heading>();
+                ch.ID = id;
+                std::cout << "Enter new altitude: \n";
+                std::cin >> ch.altitude;
+                break;
+            }
+            case 4: {
+                // Change collision-check frequency in ComputerSystem
+                msg.init(MessageType::CHANGE_TIME_CONSTRAINT_COLLISIONS);
+                std::cout << "Enter new collision time constraint (seconds): \n";
+                std::cin >> *msg.put<int>();
+                break;
+            }
+            case 5: {
+                // No payload: ComputerSystem prints its latency histograms
+                msg.init(MessageType::REQUEST_LATENCY_REPORT);
+                break;
+            }
+            case 6: {
+                // One command for many aircraft; ComputerSystem resolves the selector
+                msg.init(MessageType::REQUEST_GROUP_COMMAND);
+                msg_group_command& group = *msg.put<msg_group_command>();
+                int selector;
+                std::cout << "Select by: 1) ID list  2) Box  3) Altitude band: \n";
+                std::cin >> selector;
+                if (selector == 1) {
+                    group.selector = GroupSelector::ID_LIST;
+                    std::cout << "Number of aircraft (max " << MAX_GROUP_IDS << "): \n";
+                    std::cin >> group.count;
+                    if (group.count < 1 || group.count > MAX_GROUP_IDS) {
+                        std::cerr << "OperatorConsole: invalid number of aircraft\n";
+                        continue;
+                    }
+                    for (int i = 0; i < group.count; ++i) {
+                        std::cout << "Aircraft ID " << (i + 1) << ": \n"; std::cin >> group.ids[i];
+                    }
+                } else if (selector == 2) {
+                    group.selector = GroupSelector::BOX;
+                    std::cout << "Enter min X, max X: \n"; std::cin >> group.minX >> group.maxX;
+                    std::cout << "Enter min Y, max Y: \n"; std::cin >> group.minY >> group.maxY;
+                    std::cout << "Enter min Z, max Z: \n"; std::cin >> group.minZ >> group.maxZ;
+                } else if (selector == 3) {
+                    group.selector = GroupSelector::ALTITUDE_BAND;
+                    std::cout << "Enter min altitude, max altitude: \n"; std::cin >> group.minZ >> group.maxZ;
+                } else {
+                    std::cout << "Unknown selector\n";
+                    continue;
+                }
+
+                int command;
+                std::cout << "Command: 1) Speed  2) Position  3) Altitude: \n";
+                std::cin >> command;
+                if (command == 1) {
+                    group.command = MessageType::REQUEST_CHANGE_OF_HEADING;
+                    std::cout << "Enter new VelocityX: \n"; std::cin >> group.heading.VelocityX;
+                    std::cout << "Enter new VelocityY: \n"; std::cin >> group.heading.VelocityY;
+                    std::cout << "Enter new VelocityZ: \n"; std::cin >> group.heading.VelocityZ;
+                    std::cout << "Enter altitude: \n"; std::cin >> group.heading.altitude;
+                } else if (command == 2) {
+                    group.command = MessageType::REQUEST_CHANGE_POSITION;
+                    std::cout << "Enter X: \n"; std::cin >> group.position.x;
+                    std::cout << "Enter Y: \n"; std::cin >> group.position.y;
+                    std::cout << "Enter Z: \n"; std::cin >> group.position.z;
+                } else if (command == 3) {
+                    group.command = MessageType::REQUEST_CHANGE_ALTITUDE;
+                    std::cout << "Enter new altitude: \n"; std::cin >> group.heading.altitude;
+                } else {
+                    std::cout << "Unknown command\n";
+                    continue;
+                }
+                break;
+            }
+            case 7:
+            case 8:
+            case 9: {
+                // Answered from the ComputerSystem's index of the current frame
+                msg.init(MessageType::REQUEST_TRAFFIC_QUERY);
+                msg_traffic_query& query = *msg.put<msg_traffic_query>();
+                query.planeID = -1;
+                if (choice == 7) {
+                    query.kind = TrafficQueryKind::NEAREST;
+                    std::cout << "Enter Aircraft ID: \n"; std::cin >> query.planeID;
+                    std::cout << "Number of aircraft: \n"; std::cin >> query.k;
+                } else if (choice == 8) {
+                    query.kind = TrafficQueryKind::RADIUS;
+                    std::cout << "Enter Aircraft ID: \n"; std::cin >> query.planeID;
+                    std::cout << "Enter radius (m): \n"; std::cin >> query.radius;
+                } else {
+                    query.kind = TrafficQueryKind::BOX;
+                    std::cout << "Enter min X, max X: \n"; std::cin >> query.minX >> query.maxX;
+                    std::cout << "Enter min Y, max Y: \n"; std::cin >> query.minY >> query.maxY;
+                    std::cout << "Enter min Z, max Z: \n"; std::cin >> query.minZ >> query.maxZ;
+                }
+                msg.header.planeID = query.planeID;
+                msg_traffic_reply reply;
+                if (queryTraffic(trafficService, msg, reply)) {
+                    printTrafficReply(reply);
+                }
+                continue;
+            }
+            default:
+                std::cout << "Unknown choice\n";
+                continue;
+        }
+
+        // Send the message to ComputerSystem; group commands reply with an aggregate ack
+        msg_group_ack ack {};
+        int rc = computerSystem.send(&msg, msg.size(), &ack, sizeof(ack));
+        if (rc == -1 && errno == EBUSY) {
+            std::cerr << "OperatorConsole: command refused, CommunicationsSystem did not take it.\n";
+        } else if (rc == -1) {
+            std::cerr << "OperatorConsole: send failed: " << strerror(errno) << "\n";
+        } else if (msg.header.type == MessageType::REQUEST_GROUP_COMMAND) {
+            std::cout << "Group command: " << ack.matched << " aircraft matched, "
+                      << ack.queued << " queued, " << ack.refused << " refused.\n";
+        } else {
+            std::cout << "Command sent.\n";
+        }
+
+        // small pause to allow processing
+        usleep(100000);
+    }
+
+    std::cout << "Operator Console exiting.\n";
+    return;
+}
+
+
+// Build the message for one script line; returns false on a malformed line
+bool OperatorConsole::parseScriptLine(const std::string& text, ScriptCommand& command) {
+    std::istringstream in(text);
+    Message& msg = command.msg;
+    int id;
+
+    if (!(in >> command.sendOffsetMs >> command.name)) {
+        return false;
+    }
+
+    if (command.name == "heading") {
+        msg_change_heading ch {};
+        if (!(in >> id >> ch.VelocityX >> ch.VelocityY >> ch.VelocityZ >> ch.altitude)) return false;
+        ch.ID = id;
+        msg.init(MessageType::REQUEST_CHANGE_OF_HEADING, id);
+        *msg.put<msg_change_heading>() = ch;
+    } else if (command.name == "position") {
+        msg_change_position cp {};
+        if (!(in >> id >> cp.x >> cp.y >> cp.z)) return false;
+        msg.init(MessageType::REQUEST_CHANGE_POSITION, id);
+        *msg.put<msg_change_position>() = cp;
+    } else if (command.name == "altitude") {
+        msg_change_heading ch {};
+        if (!(in >> id >> ch.altitude)) return false;
+        ch.ID = id;
+        msg.init(MessageType::REQUEST_CHANGE_ALTITUDE, id);
+        *msg.put<msg_change_heading>() = ch;
+    } else if (command.name == "collision_freq") {
+        int freq;
+        if (!(in >> freq)) return false;
+        msg.init(MessageType::CHANGE_TIME_CONSTRAINT_COLLISIONS);
+        *msg.put<int>() = freq;
+    } else if (command.name == "report") {
+        msg.init(MessageType::REQUEST_LATENCY_REPORT);
+    } else if (command.name == "nearest" || command.name == "within" || command.name == "box") {
+        msg_traffic_query query {};
+        query.planeID = -1;
+        if (command.name == "nearest") {
+            query.kind = TrafficQueryKind::NEAREST;
+            if (!(in >> query.planeID >> query.k)) return false;
+        } else if (command.name == "within") {
+            query.kind = TrafficQueryKind::RADIUS;
+            if (!(in >> query.planeID >> query.radius)) return false;
+        } else {
+            query.kind = TrafficQueryKind::BOX;
+            if (!(in >> query.minX >> query.maxX >> query.minY >> query.maxY >> query.minZ >> query.maxZ)) return false;
+        }
+        msg.init(MessageType::REQUEST_TRAFFIC_QUERY, query.planeID);
+        *msg.put<msg_traffic_query>() = query;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool OperatorConsole::runScript(const std::string& path, bool asFastAsPossible, int pipelineDepth) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "OperatorConsole: cannot open script '" << path << "'\n";
+        return false;
+    }
+
+    std::vector<ScriptCommand> commands;
+    std::string text;
+    int lineNumber = 0;
+    while (std::getline(file, text)) {
+        ++lineNumber;
+        size_t first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos || text[first] == '#') {
+            continue;
+        }
+        ScriptCommand command;
+        command.line = lineNumber;
+        if (!parseScriptLine(text, command)) {
+            std::cerr << "OperatorConsole: skipping malformed script line " << lineNumber << ": " << text << "\n";
+            continue;
+        }
+        commands.push_back(command);
+    }
+    std::cout << "Operator Console: running " << commands.size() << " scripted commands ("
+              << (asFastAsPossible ? "as fast as possible" : "scripted times")
+              << ", pipeline depth " << pipelineDepth << ").\n";
+
+    // Dispatcher hands command indexes to the senders; at most pipelineDepth are in flight
+    std::deque<size_t> ready;
+    size_t dispatched = 0;
+    bool finished = false;
+    std::mutex readyMutex;
+    std::condition_variable readyChanged;
+
+    auto sender = [&]() {
+        ThreadProfiles::apply("console.sender");
+        // Each sender owns its connections so the sends really overlap
+        IpcConnection computerSystem;
+        IpcConnection trafficService;
+        if (!computerSystem.open(COMPUTER_SYSTEM_CHANNEL)) {
+            std::cerr << "OperatorConsole: open failed for '" << COMPUTER_SYSTEM_CHANNEL
+                      << "': " << strerror(errno) << "\n";
+        }
+        while (true) {
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(readyMutex);
+                readyChanged.wait(lock, [&] { return !ready.empty() || finished; });
+                if (ready.empty()) break;
+                index = ready.front();
+                ready.pop_front();
+                readyChanged.notify_all();
+            }
+            ScriptCommand& command = commands[index];
+            if (command.msg.header.type == MessageType::REQUEST_TRAFFIC_QUERY) {
+                msg_traffic_reply reply;
+                uint64_t sent = TimeBase::nowNs();
+                command.acknowledged = queryTraffic(trafficService, command.msg, reply);
+                command.latencyNs = TimeBase::nowNs() - sent;
+                if (command.acknowledged) {
+                    command.matches = reply.total;
+                }
+                continue;
+            }
+            if (!computerSystem.isOpen()) continue;
+
+            msg_group_ack ack {};
+            uint64_t sent = TimeBase::nowNs();
+            int rc = computerSystem.send(&command.msg, command.msg.size(), &ack, sizeof(ack));
+            int err = rc == -1 ? errno : 0;
+            command.latencyNs = TimeBase::nowNs() - sent;
+            command.acknowledged = rc != -1;
+            command.refused = err == EBUSY;
+        }
+    };
+
+    std::vector<std::thread> senders;
+    for (int i = 0; i < std::max(pipelineDepth, 1); ++i) {
+        senders.emplace_back(sender);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (dispatched = 0; dispatched < commands.size(); ++dispatched) {
+        if (!asFastAsPossible) {
+            std::this_thread::sleep_until(start + std::chrono::milliseconds(commands[dispatched].sendOffsetMs));
+        }
+        std::unique_lock<std::mutex> lock(readyMutex);
+        readyChanged.wait(lock, [&] { return ready.size() < static_cast<size_t>(std::max(pipelineDepth, 1)); });
+        ready.push_back(dispatched);
+        readyChanged.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(readyMutex);
+        finished = true;
+        readyChanged.notify_all();
+    }
+    for (std::thread& t : senders) {
+        t.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    reportScript(commands, elapsed);
+    return true;
+}
+
+void OperatorConsole::reportScript(const std::vector<ScriptCommand>& commands, double elapsedSec) {
+    std::map<std::string, std::unique_ptr<LatencyHistogram>> perType;
+    LatencyHistogram overall("all commands");
+    size_t failures = 0;
+    size_t refusals = 0;
+
+    std::cout << "\n================= Script Results =================\n"
+              << std::left << std::setw(8) << "Line" << std::setw(16) << "Command"
+              << std::setw(8) << "Plane" << "Ack latency (us)\n";
+    for (const ScriptCommand& command : commands) {
+        std::cout << std::left << std::setw(8) << command.line << std::setw(16) << command.name
+                  << std::setw(8) << command.msg.header.planeID;
+        if (command.refused) {
+            std::cout << "REFUSED\n";
+            refusals++;
+            continue;
+        }
+        if (!command.acknowledged) {
+            std::cout << "NOT ACKNOWLEDGED\n";
+            failures++;
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision(1) << command.latencyNs / 1000.0;
+        std::cout.unsetf(std::ios::fixed);
+        if (command.matches >= 0) {
+            std::cout << " (" << command.matches << " aircraft)";
+        }
+        std::cout << "\n";
+
+        std::unique_ptr<LatencyHistogram>& histogram = perType[command.name];
+        if (!histogram) histogram.reset(new LatencyHistogram(command.name));
+        histogram->record(command.latencyNs);
+        overall.record(command.latencyNs);
+    }
+
+    std::cout << "\n" << commands.size() << " commands in " << elapsedSec << " s ("
+              << (elapsedSec > 0 ? commands.size() / elapsedSec : 0.0) << " commands/s), "
+              << refusals << " refused, " << failures << " not acknowledged.\n";
+    LatencyHistogram::printHeader(std::cout);
+    for (auto& entry : perType) {
+        entry.second->print(std::cout);
+    }
+    overall.print(std::cout);
+}
+
+bool OperatorConsole::queryTraffic(IpcConnection& service, const Message& msg, msg_traffic_reply& reply) {
+    if (!service.isOpen() && !service.open(TRAFFIC_QUERY_CHANNEL)) {
+        std::cerr << "OperatorConsole: open failed for '" << TRAFFIC_QUERY_CHANNEL << "': " << strerror(errno) << "\n";
+        return false;
+    }
+    if (service.send(&msg, msg.size(), &reply, sizeof(reply)) == -1) {
+        if (errno == ENOENT) {
+            std::cerr << "OperatorConsole: aircraft " << msg.header.planeID << " is not in the current frame\n";
+        } else {
+            std::cerr << "OperatorConsole: traffic query failed: " << strerror(errno) << "\n";
+        }
+        return false;
+    }
+    return true;
+}
+
+void OperatorConsole::printTrafficReply(const msg_traffic_reply& reply) {
+    std::cout << reply.total << " aircraft (frame " << reply.generation << ", answered in "
+              << std::fixed << std::setprecision(1) << reply.serviceNs / 1000.0 << " us)\n";
+    for (int i = 0; i < reply.count; ++i) {
+        const msg_traffic_match& match = reply.matches[i];
+        std::cout << "  Plane " << match.id << " Pos(" << std::setprecision(0) << match.x << ", " << match.y << ", "
+                  << match.z << ") distance " << match.distance << " m\n";
+    }
+    if (reply.count < reply.total) {
+        std::cout << "  ... " << reply.total - reply.count << " more\n";
+    }
+    std::cout.unsetf(std::ios::fixed);
+}
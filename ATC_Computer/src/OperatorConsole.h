@@ -4,9 +4,41 @@
 #pragma once
 #include "CommunicationsSystem.h"
 #include <iostream>
-#include <sys/dispatch.h>
 #include <thread>
+#include <string>
+#include <vector>
+#include <cstdint>
 #include "Msg_structs.h"
+#include "Ipc.h"
+
+/*
+ * Scripted batch mode (runScript):
+ * Each non-empty, non-# line of the script is
+ *     <time_ms> <command> <arguments...>
+ * with <time_ms> the send time relative to the start of the script and
+ *     heading   <id> <vx> <vy> <vz> <altitude>
+ *     position  <id> <x> <y> <z>
+ *     altitude  <id> <altitude>
+ *     collision_freq <seconds>
+ *     report
+ *     nearest   <id> <k>                     (traffic queries, answered by the
+ *     within    <id> <radius_m>               ComputerSystem's TrafficQueryService)
+ *     box       <minX> <maxX> <minY> <maxY> <minZ> <maxZ>
+ * Commands are sent at their scripted times, or back to back when asFastAsPossible
+ * is set, by pipelineDepth sender threads so several commands can be in flight.
+ * The acknowledgement (send/reply round trip) latency of every command is reported,
+ * and commands ComputerSystem could not forward are reported as refused.
+ */
+struct ScriptCommand {
+	int line;                   // Line number in the script
+	uint64_t sendOffsetMs;      // Scripted send time
+	std::string name;           // Command keyword
+	Message msg;
+	bool acknowledged = false;
+	bool refused = false;       // ComputerSystem answered EBUSY: the command was not forwarded
+	uint64_t latencyNs = 0;     // Send to acknowledgement
+	int matches = -1;           // Aircraft matched by a traffic query
+};
 
 class OperatorConsole {
 public:
@@ -14,9 +46,17 @@ public:
     ~OperatorConsole();
     void start();
 
+    // Non-interactive mode: play a timestamped command script; returns false if it cannot be read
+    bool runScript(const std::string& path, bool asFastAsPossible, int pipelineDepth = 4);
+
 private:
     void HandleConsoleInputs();
     void logCommand(const std::string& command);
+    bool parseScriptLine(const std::string& text, ScriptCommand& command);
+    void reportScript(const std::vector<ScriptCommand>& commands, double elapsedSec);
+    // Send a REQUEST_TRAFFIC_QUERY, opening the connection to the query service on first use
+    bool queryTraffic(IpcConnection& service, const Message& msg, msg_traffic_reply& reply);
+    void printTrafficReply(const msg_traffic_reply& reply);
     std::thread Operator_Console;
     bool exit = false;
     CommunicationsSystem& commsRef;
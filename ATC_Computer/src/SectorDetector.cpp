@@ -0,0 +1,236 @@
+#include "SectorDetector.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include "ThreadProfile.h"
+#include "MemoryWarmup.h"
+
+SectorDetector::SectorDetector(int columns, int rows, int maxWorkers, ClosestApproachFn closestApproach,
+                               double horizon, double separation, int verifyInterval)
+	: columns(std::max(columns, 1)), rows(std::max(rows, 1)), maxWorkers(std::max(maxWorkers, 1)),
+	  closestApproach(closestApproach), horizon(horizon), separation(separation),
+	  verifyInterval(verifyInterval), sectors(this->columns * this->rows) {
+	stats.sectors.resize(sectors.size());
+	for (size_t s = 0; s < sectors.size(); ++s) {
+		stats.sectors[s].column = static_cast<int>(s) % this->columns;
+		stats.sectors[s].row = static_cast<int>(s) / this->columns;
+		// Any sector can hold every track of a frame
+		MemoryWarmup::prefault(sectors[s].tracks, SHARED_MEMORY_MAX_PLANES);
+		MemoryWarmup::prefault(sectors[s].found, SHARED_MEMORY_MAX_PLANES);
+	}
+	MemoryWarmup::prefault(merged, SHARED_MEMORY_MAX_PLANES);
+	MemoryWarmup::prefault(reference, SHARED_MEMORY_MAX_PLANES);
+
+	for (int i = 1; i < this->maxWorkers; ++i) {
+		workers.emplace_back(&SectorDetector::workerLoop, this);
+	}
+	stats.workersStarted = static_cast<int>(workers.size());
+}
+
+SectorDetector::~SectorDetector() {
+	{
+		std::lock_guard<std::mutex> lock(frameMutex);
+		stopping = true;
+	}
+	frameReady.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+int SectorDetector::columnOf(double x) const {
+	double column = std::floor((x - AIRSPACE_MIN_X) / (AIRSPACE_MAX_X - AIRSPACE_MIN_X) * columns);
+	return static_cast<int>(std::min(std::max(column, 0.0), columns - 1.0));
+}
+
+int SectorDetector::rowOf(double y) const {
+	double row = std::floor((y - AIRSPACE_MIN_Y) / (AIRSPACE_MAX_Y - AIRSPACE_MIN_Y) * rows);
+	return static_cast<int>(std::min(std::max(row, 0.0), rows - 1.0));
+}
+
+int SectorDetector::sectorOf(double x, double y) const {
+	return rowOf(y) * columns + columnOf(x);
+}
+
+void SectorDetector::assignTracks(const std::vector<msg_plane_info>& planes) {
+	for (Sector& sector : sectors) {
+		sector.tracks.clear();
+		sector.homeTracks = 0;
+	}
+	// Slightly more than half the separation, so rounding at a boundary never loses a pair
+	const double margin = separation / 2 + 1.0;
+	for (size_t i = 0; i < planes.size(); ++i) {
+		const msg_plane_info& p = planes[i];
+		double aheadX = p.PositionX + p.VelocityX * horizon;
+		double aheadY = p.PositionY + p.VelocityY * horizon;
+		int firstColumn = columnOf(std::min(p.PositionX, aheadX) - margin);
+		int lastColumn = columnOf(std::max(p.PositionX, aheadX) + margin);
+		int firstRow = rowOf(std::min(p.PositionY, aheadY) - margin);
+		int lastRow = rowOf(std::max(p.PositionY, aheadY) + margin);
+		for (int row = firstRow; row <= lastRow; ++row) {
+			for (int column = firstColumn; column <= lastColumn; ++column) {
+				sectors[row * columns + column].tracks.push_back(i);
+			}
+		}
+		sectors[sectorOf(p.PositionX, p.PositionY)].homeTracks++;
+	}
+}
+
+void SectorDetector::checkSector(Sector& sector, const std::vector<msg_plane_info>& planes) {
+	sector.found.clear();
+	sector.pairsChecked = 0;
+	const Sector* self = &sector;
+	size_t n = sector.tracks.size();
+	for (size_t a = 0; a < n; ++a) {
+		const msg_plane_info& p1 = planes[sector.tracks[a]];
+		for (size_t b = a + 1; b < n; ++b) {
+			const msg_plane_info& p2 = planes[sector.tracks[b]];
+			double tca;
+			double miss = closestApproach(p1, p2, tca);
+			sector.pairsChecked++;
+			if (miss > separation) {
+				continue;
+			}
+			// Owned by the sector of the midpoint at closest approach
+			double midX = (p1.PositionX + p2.PositionX + (p1.VelocityX + p2.VelocityX) * tca) / 2;
+			double midY = (p1.PositionY + p2.PositionY + (p1.VelocityY + p2.VelocityY) * tca) / 2;
+			if (&sectors[sectorOf(midX, midY)] != self) {
+				continue;
+			}
+			sector.found.push_back(IndexedObservation{sector.tracks[a], sector.tracks[b],
+			                                          ConflictObservation{p1.id, p2.id, tca, miss, {}}});
+		}
+	}
+}
+
+void SectorDetector::runSectors() {
+	for (size_t s = nextSector.fetch_add(1); s < sectors.size(); s = nextSector.fetch_add(1)) {
+		checkSector(sectors[s], *frame);
+	}
+}
+
+void SectorDetector::workerLoop() {
+	ThreadProfiles::apply("computer.sector");
+	MemoryWarmup::prefaultStack();
+	uint64_t seen = 0;
+	std::unique_lock<std::mutex> lock(frameMutex);
+	while (true) {
+		frameReady.wait(lock, [&] {
+			return stopping || (frameActive && frameNumber != seen && workersJoined < workersWanted);
+		});
+		if (stopping) {
+			return;
+		}
+		seen = frameNumber;
+		workersJoined++;
+		workersRunning++;
+		lock.unlock();
+		runSectors();
+		lock.lock();
+		if (--workersRunning == 0) {
+			frameDone.notify_all();
+		}
+	}
+}
+
+void SectorDetector::detect(const std::vector<msg_plane_info>& planes, std::vector<ConflictObservation>& out) {
+	assignTracks(planes);
+
+	// One thread per SECTOR_TRACKS_PER_WORKER tracks, this one included
+	int engaged = static_cast<int>((planes.size() + SECTOR_TRACKS_PER_WORKER - 1) / SECTOR_TRACKS_PER_WORKER);
+	engaged = std::min(std::max(engaged, 1), maxWorkers);
+	{
+		std::lock_guard<std::mutex> lock(frameMutex);
+		frame = &planes;
+		nextSector.store(0);
+		frameNumber++;
+		frameActive = engaged > 1;
+		workersWanted = engaged - 1;
+		workersJoined = 0;
+	}
+	if (engaged > 1) {
+		frameReady.notify_all();
+	}
+	runSectors();
+	{
+		// Every sector is taken; wait for the workers still checking theirs
+		std::unique_lock<std::mutex> lock(frameMutex);
+		frameActive = false;
+		frameDone.wait(lock, [&] { return workersRunning == 0; });
+	}
+
+	// Merge in frame order, the order of a global pass over every pair
+	merged.clear();
+	for (const Sector& sector : sectors) {
+		merged.insert(merged.end(), sector.found.begin(), sector.found.end());
+	}
+	std::sort(merged.begin(), merged.end(), [](const IndexedObservation& a, const IndexedObservation& b) {
+		return a.first != b.first ? a.first < b.first : a.second < b.second;
+	});
+	out.clear();
+	for (const IndexedObservation& found : merged) {
+		out.push_back(found.observation);
+	}
+
+	std::lock_guard<std::mutex> lock(statsMutex);
+	stats.frames++;
+	stats.maxWorkersEngaged = std::max(stats.maxWorkersEngaged, engaged);
+	for (size_t s = 0; s < sectors.size(); ++s) {
+		SectorStats& totals = stats.sectors[s];
+		totals.homeTracks += sectors[s].homeTracks;
+		totals.replicas += sectors[s].tracks.size() - sectors[s].homeTracks;
+		totals.pairsChecked += sectors[s].pairsChecked;
+		totals.conflictsOwned += sectors[s].found.size();
+	}
+
+	if (verifyInterval > 0 && stats.frames % verifyInterval == 0) {
+		detectGlobal(planes, reference);
+		bool same = reference.size() == out.size();
+		for (size_t k = 0; same && k < out.size(); ++k) {
+			same = reference[k].plane1 == out[k].plane1 && reference[k].plane2 == out[k].plane2
+			    && reference[k].timeToClosestApproach == out[k].timeToClosestApproach
+			    && reference[k].missDistance == out[k].missDistance;
+		}
+		stats.verifiedFrames++;
+		if (!same && stats.mismatches++ == 0) {
+			std::cerr << "SectorDetector: frame " << stats.frames << " differs from the global detector ("
+			          << out.size() << " vs " << reference.size() << " conflicts)\n";
+		}
+	}
+}
+
+void SectorDetector::detectGlobal(const std::vector<msg_plane_info>& planes, std::vector<ConflictObservation>& out) const {
+	out.clear();
+	size_t n = planes.size();
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = i + 1; j < n; ++j) {
+			double tca;
+			double miss = closestApproach(planes[i], planes[j], tca);
+			if (miss <= separation) {
+				out.push_back(ConflictObservation{planes[i].id, planes[j].id, tca, miss, {}});
+			}
+		}
+	}
+}
+
+SectorDetectorStats SectorDetector::getStats() {
+	std::lock_guard<std::mutex> lock(statsMutex);
+	return stats;
+}
+
+void SectorDetector::printStats(std::ostream& os) {
+	SectorDetectorStats s = getStats();
+	os << "\n================= Sectors =================\n"
+	   << columns << "x" << rows << " sectors, " << s.frames << " frames, "
+	   << s.workersStarted + 1 << " threads (at most " << s.maxWorkersEngaged << " on one frame), "
+	   << s.verifiedFrames << " frames verified against the global detector, " << s.mismatches << " mismatches\n"
+	   << std::left << std::setw(10) << "Sector" << std::right
+	   << std::setw(12) << "home" << std::setw(12) << "replicas"
+	   << std::setw(14) << "pairs" << std::setw(12) << "conflicts" << "\n";
+	for (const SectorStats& sector : s.sectors) {
+		std::string name = std::to_string(sector.column) + "," + std::to_string(sector.row);
+		os << std::left << std::setw(10) << name << std::right
+		   << std::setw(12) << sector.homeTracks << std::setw(12) << sector.replicas
+		   << std::setw(14) << sector.pairsChecked << std::setw(12) << sector.conflictsOwned << "\n";
+	}
+}
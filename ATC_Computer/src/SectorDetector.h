@@ -0,0 +1,147 @@
+/*
+ * The SectorDetector class splits conflict detection over a grid of airspace
+ * sectors, each checked on its own subset of the tracks, possibly in parallel.
+ *
+ * *****Sectors*****:
+ * The airspace (AIRSPACE_MIN_X..AIRSPACE_MAX_X by AIRSPACE_MIN_Y..AIRSPACE_MAX_Y,
+ * every altitude) is cut into columns x rows sectors. The outer sectors extend
+ * past the airspace edge, so every position belongs to exactly one sector: the
+ * home sector of a track is the one holding its current position.
+ *
+ * *****Handoff (replication)*****:
+ * A track is given to every sector that comes within separation / 2 of the
+ * ground it can cover within the look-ahead horizon (the box from its position
+ * to its position horizon seconds ahead). Tracks near a boundary, or heading
+ * across one, are therefore replicated into the neighbouring sectors.
+ *
+ * *****Ownership*****:
+ * A conflict belongs to the sector holding the midpoint of the two aircraft at
+ * their closest approach. Both aircraft are within separation / 2 of that
+ * point during the horizon, so the owning sector always holds both of them;
+ * every other sector that also sees the pair drops it. Each conflict is thus
+ * reported exactly once, and the merged list (in frame order) is the one a
+ * single global detector produces. Every verifyInterval-th frame is also run
+ * through detectGlobal() and the two results are compared.
+ *
+ * *****Workers*****:
+ * maxWorkers - 1 worker threads ("computer.sector" in threads.conf) are started
+ * with the detector and sleep until needed. Each frame engages one thread per
+ * SECTOR_TRACKS_PER_WORKER tracks, the calling thread included, up to
+ * maxWorkers; the engaged threads take the sectors one at a time until none is
+ * left. Light traffic is checked on the calling thread alone.
+ */
+
+#ifndef SECTORDETECTOR_H_
+#define SECTORDETECTOR_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include "Msg_structs.h"
+#include "AlertManager.h"
+
+// Airspace covered by the sectors (same as the aircraft's airspace_struct)
+#define AIRSPACE_MIN_X 0.0
+#define AIRSPACE_MAX_X 100000.0
+#define AIRSPACE_MIN_Y 0.0
+#define AIRSPACE_MAX_Y 100000.0
+
+#define SECTOR_TRACKS_PER_WORKER 25  // Tracks per frame before another worker is engaged
+#define SECTOR_VERIFY_INTERVAL 10    // Frames between two checks against the global detector
+
+// Miss distance (m) at the closest approach of two tracks; tca receives the time (s) to it
+typedef double (*ClosestApproachFn)(const msg_plane_info& plane1, const msg_plane_info& plane2, double& tca);
+
+// Totals of one sector over every frame
+struct SectorStats {
+	int column = 0, row = 0;
+	uint64_t homeTracks = 0;     // Tracks positioned in the sector
+	uint64_t replicas = 0;       // Tracks handed in from neighbouring sectors
+	uint64_t pairsChecked = 0;
+	uint64_t conflictsOwned = 0;
+};
+
+struct SectorDetectorStats {
+	uint64_t frames = 0;
+	int workersStarted = 0;      // Worker threads (besides the caller)
+	int maxWorkersEngaged = 0;   // Most threads on one frame, caller included
+	uint64_t verifiedFrames = 0;
+	uint64_t mismatches = 0;     // Verified frames whose sectored result differed from the global one
+	std::vector<SectorStats> sectors;
+};
+
+class SectorDetector {
+public:
+	// horizon and separation must be those of closestApproach and of the caller's conflict test
+	SectorDetector(int columns, int rows, int maxWorkers, ClosestApproachFn closestApproach,
+	               double horizon, double separation, int verifyInterval = SECTOR_VERIFY_INTERVAL);
+	~SectorDetector();
+
+	SectorDetector(const SectorDetector&) = delete;
+	SectorDetector& operator=(const SectorDetector&) = delete;
+
+	// Every pair of `planes` with a miss distance within separation, in frame order
+	void detect(const std::vector<msg_plane_info>& planes, std::vector<ConflictObservation>& out);
+
+	// The same with one global pass over every pair (reference result)
+	void detectGlobal(const std::vector<msg_plane_info>& planes, std::vector<ConflictObservation>& out) const;
+
+	SectorDetectorStats getStats();
+	void printStats(std::ostream& os);
+
+private:
+	// A conflict found by a sector, with the frame indexes of its two tracks
+	struct IndexedObservation {
+		size_t first, second;
+		ConflictObservation observation;
+	};
+
+	// One frame's work for a sector
+	struct Sector {
+		std::vector<size_t> tracks;            // Frame indexes, ascending
+		std::vector<IndexedObservation> found; // Conflicts owned by this sector
+		size_t homeTracks = 0;
+		uint64_t pairsChecked = 0;
+	};
+
+	int columnOf(double x) const;
+	int rowOf(double y) const;
+	int sectorOf(double x, double y) const;
+	void assignTracks(const std::vector<msg_plane_info>& planes);
+	void checkSector(Sector& sector, const std::vector<msg_plane_info>& planes);
+	void runSectors();  // Take sectors of the current frame until none is left
+	void workerLoop();
+
+	int columns, rows;
+	int maxWorkers;
+	ClosestApproachFn closestApproach;
+	double horizon;     // s
+	double separation;  // m
+	int verifyInterval;
+	std::vector<Sector> sectors;
+	std::vector<IndexedObservation> merged;
+	std::vector<ConflictObservation> reference;  // detectGlobal() result of a verified frame
+
+	// Current frame, handed to the workers
+	std::mutex frameMutex;
+	std::condition_variable frameReady;
+	std::condition_variable frameDone;
+	const std::vector<msg_plane_info>* frame = nullptr;
+	uint64_t frameNumber = 0;      // Incremented for each frame given to the workers
+	bool frameActive = false;      // Workers may still join the current frame
+	int workersWanted = 0;         // Workers engaged on the current frame
+	int workersJoined = 0;         // ... that have joined it
+	int workersRunning = 0;        // ... that are still inside runSectors()
+	std::atomic<size_t> nextSector{0};
+	bool stopping = false;
+	std::vector<std::thread> workers;
+
+	std::mutex statsMutex;
+	SectorDetectorStats stats;
+};
+
+#endif /* SECTORDETECTOR_H_ */
@@ -0,0 +1,91 @@
+#include "TimeBase.h"
+#include "MemoryWarmup.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+
+static SharedTimeBase* shared = nullptr;
+static bool creator = false;
+static const uint64_t processStart = monotonic_now_ns();  // Epoch until a time base is mapped
+
+static SharedTimeBase* mapTimeBase(int flags, int prot) {
+	int fd = shm_open(TIME_BASE_SHM_NAME, flags, 0666);
+	if (fd == -1) {
+		return nullptr;
+	}
+	if ((flags & O_CREAT) && !MemoryWarmup::sizeShared(fd, sizeof(SharedTimeBase))) {
+		fprintf(stderr, "TimeBase: sizing failed: %s\n", strerror(errno));
+		close(fd);
+		return nullptr;
+	}
+	void* mem = MemoryWarmup::mapShared(fd, sizeof(SharedTimeBase), prot);  // Locked and pre-faulted
+	close(fd);  // The mapping stays valid
+	if (mem == MAP_FAILED) {
+		fprintf(stderr, "TimeBase: mmap failed: %s\n", strerror(errno));
+		return nullptr;
+	}
+	return static_cast<SharedTimeBase*>(mem);
+}
+
+bool TimeBase::create(uint64_t tickPeriodNs) {
+	if (!shared) {
+		shared = mapTimeBase(O_CREAT | O_RDWR, PROT_READ | PROT_WRITE);
+		if (!shared) {
+			fprintf(stderr, "TimeBase: cannot create %s: %s\n", TIME_BASE_SHM_NAME, strerror(errno));
+			return false;
+		}
+	}
+	creator = true;
+	// The epoch is written last: a reader that sees it also sees the period and tick 0
+	shared->tick_period_ns.store(tickPeriodNs, std::memory_order_relaxed);
+	shared->tick.store(0, std::memory_order_relaxed);
+	shared->epoch_ns.store(monotonic_now_ns(), std::memory_order_release);
+	return true;
+}
+
+bool TimeBase::attach() {
+	if (shared) {
+		return true;
+	}
+	SharedTimeBase* mapped = mapTimeBase(O_RDONLY, PROT_READ);
+	if (!mapped) {
+		return false;
+	}
+	if (mapped->epoch_ns.load(std::memory_order_acquire) == 0) {
+		munmap(mapped, sizeof(SharedTimeBase));  // Created but not initialized yet
+		return false;
+	}
+	shared = mapped;
+	return true;
+}
+
+bool TimeBase::isAttached() {
+	return shared != nullptr;
+}
+
+uint64_t TimeBase::epochNs() {
+	uint64_t epoch = shared ? shared->epoch_ns.load(std::memory_order_acquire) : 0;
+	return epoch ? epoch : processStart;
+}
+
+uint64_t TimeBase::tickPeriodNs() {
+	return shared ? shared->tick_period_ns.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t TimeBase::tick() {
+	return shared ? shared->tick.load(std::memory_order_acquire) : 0;
+}
+
+void TimeBase::advance(uint64_t ticks) {
+	if (shared && creator) {
+		shared->tick.fetch_add(ticks, std::memory_order_release);
+	}
+}
+
+double TimeBase::toSeconds(uint64_t monotonicNs) {
+	return (double)(int64_t)(monotonicNs - epochNs()) / 1e9;
+}
@@ -0,0 +1,52 @@
+/*
+ * The TimeBase class gives every ATC process the same notion of time.
+ *
+ * *****Shared time base*****:
+ * Lab4 creates the "/atc_time" shared memory segment (SharedTimeBase) when the
+ * simulation starts and advances its tick once per tick period. ComputerSystem
+ * and Display attach to it. Reads are single atomic loads: no lock, no IPC.
+ *
+ *   epoch    CLOCK_MONOTONIC time (ns) of tick 0
+ *   tick     simulation ticks elapsed since the epoch
+ *   period   length of a tick (ns)
+ *
+ * *****Clock*****:
+ * All timestamps (latency traces, frame publish times, aircraft state times)
+ * are CLOCK_MONOTONIC nanoseconds from nowNs() / monotonic_now_ns(). That clock
+ * is the same in every process on the node, so timestamps taken in different
+ * processes can be subtracted; toSeconds() expresses one relative to the epoch.
+ *
+ * Before create() or attach() succeeds, the epoch is the start of the calling
+ * process and the tick stays 0.
+ */
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+#include <cstdint>
+#include "Msg_structs.h"
+
+class TimeBase {
+public:
+	// Lab4: create (or reset) the shared time base; tick 0 starts now
+	static bool create(uint64_t tickPeriodNs);
+	// Other processes: map the time base published by Lab4; false if it does not exist yet
+	static bool attach();
+	static bool isAttached();
+
+	// CLOCK_MONOTONIC in nanoseconds
+	static uint64_t nowNs() { return monotonic_now_ns(); }
+
+	static uint64_t epochNs();
+	static uint64_t tickPeriodNs();
+	static uint64_t tick();
+
+	// Creator only: count `ticks` more simulation ticks
+	static void advance(uint64_t ticks);
+
+	// Seconds from the epoch to a nowNs() timestamp
+	static double toSeconds(uint64_t monotonicNs);
+	static double nowSeconds() { return toSeconds(nowNs()); }
+};
+
+#endif /* TIMEBASE_H_ */
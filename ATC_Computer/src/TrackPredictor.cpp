@@ -0,0 +1,87 @@
+#include "TrackPredictor.h"
+#include "TimeBase.h"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+TrackPredictor::TrackPredictor() {}
+
+double TrackPredictor::now() {
+	return TimeBase::nowSeconds();
+}
+
+msg_plane_info TrackPredictor::extrapolate(const Track& track, double queryTime) {
+	double dt = queryTime - track.time;
+	msg_plane_info predicted = track.state;
+	predicted.PositionX += track.state.VelocityX * dt;
+	predicted.PositionY += track.state.VelocityY * dt;
+	predicted.PositionZ += track.state.VelocityZ * dt;
+	return predicted;
+}
+
+void TrackPredictor::update(const std::vector<msg_plane_info>& frame, double frameTime) {
+	std::lock_guard<std::mutex> lock(tracksMutex);
+	std::map<int, Track> corrected;
+	double frameError = 0.0;
+
+	for (const msg_plane_info& measured : frame) {
+		// The state is valid when the aircraft produced it, on the same time base as ours
+		double measuredAt = measured.stateTime ? TimeBase::toSeconds(measured.stateTime) : frameTime;
+		auto it = tracks.find(measured.id);
+		if (it != tracks.end()) {
+			// Compare what we predicted for this instant against what the radar saw
+			msg_plane_info predicted = extrapolate(it->second, measuredAt);
+			double dx = measured.PositionX - predicted.PositionX;
+			double dy = measured.PositionY - predicted.PositionY;
+			double dz = measured.PositionZ - predicted.PositionZ;
+			double error = std::sqrt(dx*dx + dy*dy + dz*dz);
+
+			samples++;
+			sumError += error;
+			sumSquaredError += error * error;
+			if (error > maxError) maxError = error;
+			if (error > frameError) frameError = error;
+		}
+		// The measurement always replaces the prediction
+		corrected[measured.id] = Track{measured, measuredAt};
+	}
+
+	// Planes missing from the frame have left the airspace
+	tracks.swap(corrected);
+	lastFrameError = frameError;
+}
+
+std::vector<msg_plane_info> TrackPredictor::predict(double queryTime) {
+	std::lock_guard<std::mutex> lock(tracksMutex);
+	std::vector<msg_plane_info> predicted;
+	predicted.reserve(tracks.size());
+	for (const auto& entry : tracks) {
+		predicted.push_back(extrapolate(entry.second, queryTime));
+	}
+	return predicted;
+}
+
+PredictionStats TrackPredictor::getStats() {
+	std::lock_guard<std::mutex> lock(tracksMutex);
+	PredictionStats stats;
+	stats.samples = samples;
+	if (samples > 0) {
+		stats.meanError = sumError / samples;
+		stats.rmsError = std::sqrt(sumSquaredError / samples);
+	}
+	stats.maxError = maxError;
+	stats.lastFrameError = lastFrameError;
+	return stats;
+}
+
+void TrackPredictor::printStats() {
+	PredictionStats stats = getStats();
+	std::cout << "\n================= Prediction Error =================\n"
+	          << std::fixed << std::setprecision(2)
+	          << "Samples: " << stats.samples
+	          << "  mean: " << stats.meanError << " m"
+	          << "  rms: " << stats.rmsError << " m"
+	          << "  max: " << stats.maxError << " m"
+	          << "  last frame: " << stats.lastFrameError << " m\n";
+	std::cout.unsetf(std::ios::fixed);
+}
@@ -0,0 +1,69 @@
+/*
+ * The TrackPredictor class dead-reckons every track between radar frames.
+ *
+ * Radar frames only arrive once per second. Each time a frame is received,
+ * update() first measures how far the previous prediction was from the new
+ * measurement (prediction error), then corrects each track with the measured
+ * position and velocity. predict() extrapolates all tracks linearly from their
+ * last measurement to any query time, so the conflict check can run between
+ * frames without polling the radar more often.
+ *
+ * Times are in seconds since the epoch of the shared time base (see now() and
+ * TimeBase), so a track is anchored at the instant the aircraft produced its
+ * state (stateTime) rather than when the frame was read. Velocities are in
+ * meters per second, as published by the aircraft.
+ */
+
+#ifndef TRACKPREDICTOR_H_
+#define TRACKPREDICTOR_H_
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include "Msg_structs.h"
+
+struct PredictionStats {
+	uint64_t samples = 0;      // Predictions compared against a real frame
+	double meanError = 0.0;    // meters
+	double rmsError = 0.0;     // meters
+	double maxError = 0.0;     // meters
+	double lastFrameError = 0.0;  // Largest error seen on the most recent frame
+};
+
+class TrackPredictor {
+public:
+	TrackPredictor();
+
+	// Current time on the predictor's clock (seconds)
+	static double now();
+
+	// Correct all tracks with a newly received frame; frameTime stands in for a missing stateTime
+	void update(const std::vector<msg_plane_info>& frame, double frameTime);
+
+	// Extrapolate every track to the query time
+	std::vector<msg_plane_info> predict(double queryTime);
+
+	PredictionStats getStats();
+	void printStats();
+
+private:
+	struct Track {
+		msg_plane_info state;  // Last measured state
+		double time;           // When it was measured
+	};
+
+	static msg_plane_info extrapolate(const Track& track, double queryTime);
+
+	std::map<int, Track> tracks;
+	std::mutex tracksMutex;
+
+	// Running error accumulators
+	uint64_t samples = 0;
+	double sumError = 0.0;
+	double sumSquaredError = 0.0;
+	double maxError = 0.0;
+	double lastFrameError = 0.0;
+};
+
+#endif /* TRACKPREDICTOR_H_ */
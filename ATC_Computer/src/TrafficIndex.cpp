@@ -0,0 +1,161 @@
+#include "TrafficIndex.h"
+#include <algorithm>
+#include <cmath>
+
+TrafficIndex::TrafficIndex(double cellSize)
+	: cellSize(cellSize),
+	  columns(std::max(1, static_cast<int>(std::ceil((AIRSPACE_MAX_X - AIRSPACE_MIN_X) / cellSize)))),
+	  rows(std::max(1, static_cast<int>(std::ceil((AIRSPACE_MAX_Y - AIRSPACE_MIN_Y) / cellSize)))),
+	  cells(columns * rows) {
+	planes.reserve(SHARED_MEMORY_MAX_PLANES);
+	gone.reserve(SHARED_MEMORY_MAX_PLANES);
+}
+
+int TrafficIndex::columnOf(double x) const {
+	double column = std::floor((x - AIRSPACE_MIN_X) / cellSize);
+	return static_cast<int>(std::min(std::max(column, 0.0), columns - 1.0));
+}
+
+int TrafficIndex::rowOf(double y) const {
+	double row = std::floor((y - AIRSPACE_MIN_Y) / cellSize);
+	return static_cast<int>(std::min(std::max(row, 0.0), rows - 1.0));
+}
+
+void TrafficIndex::removeFromCell(int cell, int id) {
+	std::vector<int>& ids = cells[cell];
+	auto it = std::find(ids.begin(), ids.end(), id);
+	if (it != ids.end()) {
+		*it = ids.back();
+		ids.pop_back();
+	}
+}
+
+void TrafficIndex::update(const std::vector<msg_plane_info>& frame) {
+	uint64_t number = ++stats.frames;
+	for (const msg_plane_info& plane : frame) {
+		int cell = rowOf(plane.PositionY) * columns + columnOf(plane.PositionX);
+		auto it = planes.find(plane.id);
+		if (it == planes.end()) {
+			planes.emplace(plane.id, Entry{plane, cell, number});
+			cells[cell].push_back(plane.id);
+			stats.inserted++;
+			continue;
+		}
+		Entry& entry = it->second;
+		entry.info = plane;
+		entry.frame = number;
+		if (entry.cell == cell) {
+			stats.refreshed++;
+			continue;
+		}
+		removeFromCell(entry.cell, plane.id);
+		cells[cell].push_back(plane.id);
+		entry.cell = cell;
+		stats.moved++;
+	}
+
+	// Aircraft no longer in the frame
+	gone.clear();
+	for (const auto& entry : planes) {
+		if (entry.second.frame != number) {
+			gone.push_back(entry.first);
+		}
+	}
+	for (int id : gone) {
+		removeFromCell(planes[id].cell, id);
+		planes.erase(id);
+		stats.removed++;
+	}
+}
+
+const msg_plane_info* TrafficIndex::find(int id) const {
+	auto it = planes.find(id);
+	return it == planes.end() ? nullptr : &it->second.info;
+}
+
+void TrafficIndex::collect(int column, int row, double x, double y, double z, double maxDistance, int excludeId,
+                           std::vector<msg_traffic_match>& out) const {
+	for (int id : cells[row * columns + column]) {
+		if (id == excludeId) {
+			continue;
+		}
+		const msg_plane_info& p = planes.at(id).info;
+		double distance = std::sqrt((p.PositionX - x) * (p.PositionX - x) + (p.PositionY - y) * (p.PositionY - y)
+		                            + (p.PositionZ - z) * (p.PositionZ - z));
+		if (maxDistance < 0 || distance <= maxDistance) {
+			out.push_back(msg_traffic_match{id, distance, p.PositionX, p.PositionY, p.PositionZ});
+		}
+	}
+}
+
+static bool closer(const msg_traffic_match& a, const msg_traffic_match& b) {
+	return a.distance != b.distance ? a.distance < b.distance : a.id < b.id;
+}
+
+void TrafficIndex::nearest(double x, double y, double z, size_t k, int excludeId, std::vector<msg_traffic_match>& out) const {
+	out.clear();
+	if (k == 0) {
+		return;
+	}
+	int centreColumn = columnOf(x), centreRow = rowOf(y);
+	int lastRing = std::max(std::max(centreColumn, columns - 1 - centreColumn), std::max(centreRow, rows - 1 - centreRow));
+	for (int ring = 0; ring <= lastRing; ++ring) {
+		for (int row = centreRow - ring; row <= centreRow + ring; ++row) {
+			if (row < 0 || row >= rows) {
+				continue;
+			}
+			// Whole rows at the top and bottom of the ring, the two end cells in between
+			bool edge = row == centreRow - ring || row == centreRow + ring;
+			int step = edge ? 1 : std::max(2 * ring, 1);
+			for (int column = centreColumn - ring; column <= centreColumn + ring; column += step) {
+				if (column >= 0 && column < columns) {
+					collect(column, row, x, y, z, -1.0, excludeId, out);
+				}
+			}
+		}
+		// Anything in the next ring is at least ring cells away from the centre
+		if (out.size() >= k) {
+			std::nth_element(out.begin(), out.begin() + (k - 1), out.end(), closer);
+			if (out[k - 1].distance <= ring * cellSize) {
+				break;
+			}
+		}
+	}
+	std::sort(out.begin(), out.end(), closer);
+	if (out.size() > k) {
+		out.resize(k);
+	}
+}
+
+void TrafficIndex::within(double x, double y, double z, double radius, int excludeId, std::vector<msg_traffic_match>& out) const {
+	out.clear();
+	if (radius < 0) {
+		return;
+	}
+	for (int row = rowOf(y - radius); row <= rowOf(y + radius); ++row) {
+		for (int column = columnOf(x - radius); column <= columnOf(x + radius); ++column) {
+			collect(column, row, x, y, z, radius, excludeId, out);
+		}
+	}
+	std::sort(out.begin(), out.end(), closer);
+}
+
+void TrafficIndex::box(double minX, double maxX, double minY, double maxY, double minZ, double maxZ,
+                       std::vector<msg_traffic_match>& out) const {
+	out.clear();
+	if (minX > maxX || minY > maxY) {
+		return;
+	}
+	for (int row = rowOf(minY); row <= rowOf(maxY); ++row) {
+		for (int column = columnOf(minX); column <= columnOf(maxX); ++column) {
+			for (int id : cells[row * columns + column]) {
+				const msg_plane_info& p = planes.at(id).info;
+				if (p.PositionX >= minX && p.PositionX <= maxX && p.PositionY >= minY && p.PositionY <= maxY
+				    && p.PositionZ >= minZ && p.PositionZ <= maxZ) {
+					out.push_back(msg_traffic_match{id, 0.0, p.PositionX, p.PositionY, p.PositionZ});
+				}
+			}
+		}
+	}
+	std::sort(out.begin(), out.end(), [](const msg_traffic_match& a, const msg_traffic_match& b) { return a.id < b.id; });
+}
@@ -0,0 +1,87 @@
+/*
+ * The TrafficIndex class keeps the aircraft of the current frame in a uniform
+ * grid, so that nearest-neighbour, radius and box queries only look at the
+ * cells around the query instead of every aircraft.
+ *
+ * *****Grid*****:
+ * The airspace (AIRSPACE_MIN_X..AIRSPACE_MAX_X by AIRSPACE_MIN_Y..AIRSPACE_MAX_Y,
+ * see SectorDetector.h) is cut into square cells of cellSize meters, every
+ * altitude in the same cell. The outer cells extend past the airspace edge.
+ *
+ * *****Updates*****:
+ * update() brings the index to a new frame incrementally: an aircraft that
+ * stays in its cell is only refreshed, one that crossed into another cell is
+ * moved, and aircraft missing from the frame are removed.
+ *
+ * *****Queries*****:
+ *   nearest   visits rings of cells around the centre, one ring at a time, and
+ *             stops once k aircraft are closer than anything the next ring
+ *             can hold
+ *   within    the cells overlapping the circle, then the exact 3D distance
+ *   box       the cells overlapping the box, then the exact bounds
+ * Distances are 3D. Not thread-safe: the caller serializes updates and queries.
+ */
+
+#ifndef TRAFFICINDEX_H_
+#define TRAFFICINDEX_H_
+
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "Msg_structs.h"
+#include "SectorDetector.h"  // AIRSPACE_* bounds
+
+#define TRAFFIC_CELL_SIZE 5000.0  // m
+
+struct TrafficIndexStats {
+	uint64_t frames = 0;
+	uint64_t refreshed = 0;  // Aircraft that stayed in their cell
+	uint64_t moved = 0;      // ... that crossed into another cell
+	uint64_t inserted = 0;
+	uint64_t removed = 0;
+};
+
+class TrafficIndex {
+public:
+	TrafficIndex(double cellSize = TRAFFIC_CELL_SIZE);
+
+	void update(const std::vector<msg_plane_info>& planes);
+
+	// Aircraft of the current frame, nullptr if absent
+	const msg_plane_info* find(int id) const;
+	size_t size() const { return planes.size(); }
+
+	// The k aircraft closest to (x, y, z), nearest first; excludeId is skipped
+	void nearest(double x, double y, double z, size_t k, int excludeId, std::vector<msg_traffic_match>& out) const;
+	// Aircraft within radius of (x, y, z), nearest first; excludeId is skipped
+	void within(double x, double y, double z, double radius, int excludeId, std::vector<msg_traffic_match>& out) const;
+	// Aircraft inside the box (bounds included), by ID
+	void box(double minX, double maxX, double minY, double maxY, double minZ, double maxZ,
+	         std::vector<msg_traffic_match>& out) const;
+
+	const TrafficIndexStats& getStats() const { return stats; }
+
+private:
+	struct Entry {
+		msg_plane_info info;
+		int cell;
+		uint64_t frame;  // Last frame the aircraft was in
+	};
+
+	int columnOf(double x) const;
+	int rowOf(double y) const;
+	void removeFromCell(int cell, int id);
+	// Candidates of one cell within maxDistance (a negative maxDistance keeps every one)
+	void collect(int column, int row, double x, double y, double z, double maxDistance, int excludeId,
+	             std::vector<msg_traffic_match>& out) const;
+
+	double cellSize;
+	int columns, rows;
+	std::vector<std::vector<int>> cells;  // IDs per cell, row-major
+	std::unordered_map<int, Entry> planes;
+	std::vector<int> gone;                // Scratch list of the removed IDs
+	TrafficIndexStats stats;
+};
+
+#endif /* TRAFFICINDEX_H_ */
@@ -0,0 +1,156 @@
+#include "TrafficQueryService.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <errno.h>
+#include "TimeBase.h"
+#include "ThreadProfile.h"
+#include "MemoryWarmup.h"
+
+TrafficQueryService::TrafficQueryService() : server(TRAFFIC_QUERY_CHANNEL) {
+	MemoryWarmup::prefault(frame, SHARED_MEMORY_MAX_PLANES);
+	MemoryWarmup::prefault(matches, SHARED_MEMORY_MAX_PLANES);
+}
+
+TrafficQueryService::~TrafficQueryService() {
+	stop();
+}
+
+bool TrafficQueryService::start(SharedMemory* frame) {
+	if (!server.isAttached()) {
+		std::cerr << "TrafficQueryService: attach failed for '" << TRAFFIC_QUERY_CHANNEL << "': " << strerror(errno) << "\n";
+		return false;
+	}
+	shared_mem = frame;
+	running.store(true);
+	follower = std::thread(&TrafficQueryService::followFrames, this);
+	responder = std::thread(&TrafficQueryService::serveQueries, this);
+	std::cout << "TrafficQueryService: query channel attached as '" << TRAFFIC_QUERY_CHANNEL << "'.\n";
+	return true;
+}
+
+void TrafficQueryService::stop() {
+	running.store(false);
+	// Unblocks the responder; the follower sees the flag within a second
+	server.detach();
+	if (responder.joinable()) {
+		responder.join();
+	}
+	if (follower.joinable()) {
+		follower.join();
+	}
+}
+
+void TrafficQueryService::followFrames() {
+	ThreadProfiles::apply("computer.query");
+	MemoryWarmup::prefaultStack();
+	uint64_t lastGeneration = 0;
+	while (running.load()) {
+		struct timespec deadline;
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += 1;
+
+		pthread_mutex_lock(&shared_mem->frame_mutex);
+		bool fresh = true;
+		while (shared_mem->generation == lastGeneration) {
+			if (pthread_cond_timedwait(&shared_mem->frame_cond, &shared_mem->frame_mutex, &deadline) == ETIMEDOUT) {
+				fresh = false;
+				break;
+			}
+		}
+		if (fresh) {
+			lastGeneration = shared_mem->generation;
+			frame.assign(shared_mem->plane_data, shared_mem->plane_data + (shared_mem->is_empty.load() ? 0 : shared_mem->count));
+		}
+		pthread_mutex_unlock(&shared_mem->frame_mutex);
+		if (!fresh) {
+			continue;
+		}
+
+		uint64_t start = TimeBase::nowNs();
+		std::lock_guard<std::mutex> lock(indexMutex);
+		index.update(frame);
+		generation = lastGeneration;
+		updateLatency.recordInterval(start, TimeBase::nowNs());
+	}
+}
+
+void TrafficQueryService::serveQueries() {
+	ThreadProfiles::apply("computer.query");
+	MemoryWarmup::prefaultStack();
+	msg_traffic_reply reply;
+	while (running.load()) {
+		Message incoming;
+		size_t length = 0;
+		int rcvid = server.receive(&incoming, sizeof(incoming), length);
+		if (rcvid == -1) {
+			if (errno == EINTR) continue;
+			break;  // Detached by stop()
+		}
+		uint64_t received = TimeBase::nowNs();
+		const msg_traffic_query* query = incoming.valid(length) ? incoming.get<msg_traffic_query>() : nullptr;
+		if (!query || incoming.header.type != MessageType::REQUEST_TRAFFIC_QUERY) {
+			server.error(rcvid, EPROTO);
+			continue;
+		}
+		queries++;
+		if (!answer(*query, reply)) {
+			unknownPlane++;
+			server.error(rcvid, ENOENT);
+			continue;
+		}
+		reply.serviceNs = TimeBase::nowNs() - received;
+		queryLatency.record(reply.serviceNs);
+		// Only the listed matches go on the wire
+		size_t size = offsetof(msg_traffic_reply, matches) + reply.count * sizeof(msg_traffic_match);
+		server.reply(rcvid, EOK, &reply, size);
+	}
+}
+
+bool TrafficQueryService::answer(const msg_traffic_query& query, msg_traffic_reply& reply) {
+	std::lock_guard<std::mutex> lock(indexMutex);
+	double x = query.x, y = query.y, z = query.z;
+	if (query.kind != TrafficQueryKind::BOX && query.planeID >= 0) {
+		const msg_plane_info* centre = index.find(query.planeID);
+		if (!centre) {
+			return false;
+		}
+		x = centre->PositionX;
+		y = centre->PositionY;
+		z = centre->PositionZ;
+	}
+	switch (query.kind) {
+	case TrafficQueryKind::NEAREST:
+		index.nearest(x, y, z, std::max(query.k, 0), query.planeID, matches);
+		break;
+	case TrafficQueryKind::RADIUS:
+		index.within(x, y, z, query.radius, query.planeID, matches);
+		break;
+	case TrafficQueryKind::BOX:
+		index.box(query.minX, query.maxX, query.minY, query.maxY, query.minZ, query.maxZ, matches);
+		break;
+	}
+	reply.generation = generation;
+	reply.total = static_cast<int>(matches.size());
+	reply.count = std::min(reply.total, TRAFFIC_QUERY_MAX_MATCHES);
+	std::copy(matches.begin(), matches.begin() + reply.count, reply.matches);
+	return true;
+}
+
+void TrafficQueryService::printStats(std::ostream& os) {
+	TrafficIndexStats s;
+	size_t tracked;
+	{
+		std::lock_guard<std::mutex> lock(indexMutex);
+		s = index.getStats();
+		tracked = index.size();
+	}
+	os << "\n================= Traffic Queries =================\n"
+	   << queries.load() << " queries (" << unknownPlane.load() << " on an aircraft not in the frame), "
+	   << tracked << " aircraft indexed; over " << s.frames << " frames " << s.refreshed << " refreshed in place, "
+	   << s.moved << " moved cell, " << s.inserted << " inserted, " << s.removed << " removed\n";
+	LatencyHistogram::printHeader(os);
+	updateLatency.print(os);
+	queryLatency.print(os);
+}
@@ -0,0 +1,70 @@
+/*
+ * The TrafficQueryService class answers "which aircraft are near plane X" and
+ * "what is in this box" over IPC, from a TrafficIndex of the current frame.
+ *
+ * *****Frames*****:
+ * A follower thread waits on the publish notification of the radar frame
+ * (SharedMemory::generation) and applies each new generation to the index
+ * incrementally (see TrafficIndex). It runs beside the monitoring loop of the
+ * ComputerSystem and never delays it: both only read the shared frame.
+ *
+ * *****Queries*****:
+ * REQUEST_TRAFFIC_QUERY messages (msg_traffic_query) are received on
+ * TRAFFIC_QUERY_CHANNEL and answered with a msg_traffic_reply computed on the
+ * latest generation. A query centred on an aircraft that is not in the frame
+ * fails with ENOENT. The index is shared by the two threads under one mutex,
+ * held for one update or one query, so an answer costs microseconds.
+ */
+
+#ifndef TRAFFICQUERYSERVICE_H_
+#define TRAFFICQUERYSERVICE_H_
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include "Msg_structs.h"
+#include "Ipc.h"
+#include "LatencyHistogram.h"
+#include "TrafficIndex.h"
+
+#define TRAFFIC_QUERY_CHANNEL "traffic_query_channel"
+
+class TrafficQueryService {
+public:
+	TrafficQueryService();
+	~TrafficQueryService();
+
+	// Follow the frames of this mapped segment and start answering queries
+	bool start(SharedMemory* frame);
+	void stop();
+
+	void printStats(std::ostream& os);
+
+private:
+	void followFrames();
+	void serveQueries();
+	// False if the query is centred on an aircraft absent from the frame
+	bool answer(const msg_traffic_query& query, msg_traffic_reply& reply);
+
+	SharedMemory* shared_mem = nullptr;
+	IpcServer server;
+	std::thread follower;
+	std::thread responder;
+	std::atomic<bool> running{false};
+
+	std::mutex indexMutex;
+	TrafficIndex index;
+	uint64_t generation = 0;                // Generation the index holds
+	std::vector<msg_plane_info> frame;      // Follower thread only
+	std::vector<msg_traffic_match> matches; // Responder thread only, under indexMutex
+
+	std::atomic<uint64_t> queries{0};
+	std::atomic<uint64_t> unknownPlane{0};
+	LatencyHistogram updateLatency{"traffic index update"};
+	LatencyHistogram queryLatency{"traffic query"};
+};
+
+#endif /* TRAFFICQUERYSERVICE_H_ */
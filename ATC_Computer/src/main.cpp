@@ -1,17 +1,52 @@
 #include "ComputerSystem.h"
 #include "OperatorConsole.h"
 #include "CommunicationsSystem.h"
+#include "ThreadProfile.h"
+#include "MemoryWarmup.h"
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+
+// Usage: ATC_Computer [--script <file> [--fast] [--pipeline <depth>]] [--sectors <columns>x<rows>]
+// Without --script the interactive operator menu is used.
+// --sectors sets the grid the conflict check is split over (default 2x2).
+int main(int argc, char* argv[]) {
+    std::string scriptPath;
+    bool fast = false;
+    int pipelineDepth = 4;
+    int sectorColumns = 2, sectorRows = 2;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--script" && i + 1 < argc) {
+            scriptPath = argv[++i];
+        } else if (arg == "--fast") {
+            fast = true;
+        } else if (arg == "--pipeline" && i + 1 < argc) {
+            pipelineDepth = std::atoi(argv[++i]);
+        } else if (arg == "--sectors" && i + 1 < argc
+                   && std::sscanf(argv[++i], "%dx%d", &sectorColumns, &sectorRows) == 2
+                   && sectorColumns > 0 && sectorRows > 0) {
+            continue;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--script <file> [--fast] [--pipeline <depth>]] [--sectors <columns>x<rows>]\n";
+            return 1;
+        }
+    }
+
+    // Scheduling policy, priority and CPUs of each thread role (threads.conf)
+    ThreadProfiles::loadDefault();
+    // Warm phase: everything mapped from here on stays resident (see MemoryWarmup.h)
+    MemoryWarmup::lockProcessMemory();
 
-int main() {
     CommunicationsSystem comms;
     comms.start();
-    ComputerSystem computerSystem;
+    ComputerSystem computerSystem(sectorColumns, sectorRows);
     OperatorConsole console(comms);
     // Task 4 (You need to first implement Task 3)
     /*
     You need to implement OperatorConsolde to send commands to Aircraft
     You may make another class and read user commands to adjust the aircraft data in case of collision.
-    You may use Message_inter_process with MessageType to communicate with Aircrafts:
+    You may use Message (init with a MessageType, put<T> a payload) to communicate with Aircrafts:
     MessageType::REQUEST_CHANGE_OF_HEADING, MessageType::REQUEST_CHANGE_POSITION, MessageType::REQUEST_CHANGE_ALTITUDE
     // check OperatorConsole.h and CommunicationsSystem.h for a template
     // OperatorConsole console;
@@ -19,7 +54,11 @@ int main() {
     */
 
     if (computerSystem.startMonitoring()) {
-    	console.start();
+    	if (scriptPath.empty()) {
+    		console.start();
+    	} else {
+    		console.runScript(scriptPath, fast, pipelineDepth);
+    	}
         computerSystem.joinThread();
     } else {
             std::cerr << "Failed to start monitoring." << std::endl;
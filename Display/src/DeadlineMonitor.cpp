@@ -0,0 +1,78 @@
+#include "DeadlineMonitor.h"
+#include "ThreadProfile.h"
+#include "MemoryWarmup.h"
+#include <iomanip>
+#include <cmath>
+
+DeadlineMonitor::DeadlineMonitor(const std::string& name, ATCTimer& timer, double periodMs, double deadlineMs)
+	: timer(timer) {
+	stats.name = name;
+	stats.periodMs = periodMs;
+	stats.deadlineMs = deadlineMs > 0.0 ? deadlineMs : periodMs;
+}
+
+void DeadlineMonitor::release() {
+	if (released) {
+		// Time since the previous release
+		double intervalMs = timer.tock();
+		double jitterMs = std::fabs(intervalMs - stats.periodMs);
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+		totalJitterMs += jitterMs;
+		jitterSamples++;
+		stats.avgJitterMs = totalJitterMs / jitterSamples;
+		if (jitterMs > stats.maxJitterMs) stats.maxJitterMs = jitterMs;
+
+		// A release arriving two or more periods late means periods were skipped
+		if (stats.periodMs > 0.0) {
+			uint64_t periods = static_cast<uint64_t>(intervalMs / stats.periodMs + 0.5);
+			if (periods > 1) {
+				stats.skippedPeriods += periods - 1;
+			}
+		}
+	}
+	released = true;
+	faultsAtRelease = MemoryWarmup::pageFaults();
+	timer.tick();
+}
+
+void DeadlineMonitor::complete() {
+	if (!released) {
+		return;
+	}
+	double execMs = timer.tock();
+	long faults = faultsAtRelease < 0 ? 0 : MemoryWarmup::pageFaults() - faultsAtRelease;
+
+	std::lock_guard<std::mutex> lock(statsMutex);
+	stats.iterations++;
+	if (stats.iterations <= WARMUP_ITERATIONS) {
+		stats.warmupPageFaults += faults;
+	} else {
+		stats.steadyPageFaults += faults;
+	}
+	totalExecMs += execMs;
+	stats.avgExecMs = totalExecMs / stats.iterations;
+	if (stats.iterations == 1 || execMs < stats.minExecMs) stats.minExecMs = execMs;
+	if (execMs > stats.maxExecMs) stats.maxExecMs = execMs;
+	if (execMs > stats.deadlineMs) {
+		stats.deadlineMisses++;
+	}
+	ThreadProfiles::sample();  // Once per period of the monitored thread
+}
+
+DeadlineStats DeadlineMonitor::getStats() {
+	std::lock_guard<std::mutex> lock(statsMutex);
+	return stats;
+}
+
+void DeadlineMonitor::printStats() {
+	DeadlineStats s = getStats();
+	std::cout << std::fixed << std::setprecision(3)
+	          << "[" << s.name << "] period " << s.periodMs << " ms, deadline " << s.deadlineMs << " ms: "
+	          << s.iterations << " iterations, " << s.deadlineMisses << " deadline misses, "
+	          << s.skippedPeriods << " skipped periods, exec min/avg/max "
+	          << s.minExecMs << "/" << s.avgExecMs << "/" << s.maxExecMs << " ms, jitter avg/max "
+	          << s.avgJitterMs << "/" << s.maxJitterMs << " ms, page faults warm-up/steady "
+	          << s.warmupPageFaults << "/" << s.steadyPageFaults << "\n";
+	std::cout.unsetf(std::ios::fixed);
+}
@@ -1,4 +1,3 @@
-#include <sys/dispatch.h>
 #include <iostream>
 #include <vector>
 #include <thread>
@@ -8,10 +7,30 @@
 #include <sys/mman.h>
 #include <algorithm>
 #include <cmath>
-#include "Msg_structs.h"  // Your shared structs (SharedMemory, msg_plane_info, Message_inter_process)
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <pthread.h>
+#include <csignal>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <termios.h>
+#include <poll.h>
+#include <map>
+#include <set>
+#include "Msg_structs.h"  // Your shared structs (SharedMemory, msg_plane_info, Message)
+#include "LatencyHistogram.h"
+#include "ATCTimer.h"
+#include "DeadlineMonitor.h"
+#include "GridRenderer.h"
+#include "SpatialIndex.h"
+#include "Ipc.h"
+#include "TimeBase.h"
+#include "ThreadProfile.h"
+#include "MemoryWarmup.h"
 
 #define DISPLAY_CHANNEL "chris_display"
-#define COLLISION_CHANNEL "chris_collision"
 #define SHM_NAME "/radar_shm"
 #define SHARED_MEMORY_SIZE sizeof(SharedMemory)
 
@@ -22,168 +41,458 @@
 // Airspace limits
 #define MAX_X 100000.0
 #define MAX_Y 100000.0
-#define MAX_Z 25000.0
+#define MIN_Z 15000.0
+#define MAX_Z 40000.0
+
+// Viewport: zoom levels 1x..16x, altitude slices of ALT_SLICE between MIN_Z and MAX_Z
+#define MAX_ZOOM 16
+#define ALT_SLICE 5000.0
+#define ALT_SLICES 5
+// Spatial index tile size: the 16x viewport spans 2 x 1 tiles
+#define TILE_SIZE 5000.0
 
 SharedMemory* shared_mem = nullptr;
+
+// Sensor-to-alert latency, per stage of latency_trace, recorded for every printed alert.
+// Dumped on SIGUSR1, and on SIGINT/SIGTERM before exiting.
+LatencyHistogram statePollLatency("aircraft state -> radar poll");
+LatencyHistogram pollPublishLatency("radar poll -> publish");
+LatencyHistogram publishReadLatency("publish -> monitor read");
+LatencyHistogram readDetectLatency("monitor read -> conflict check");
+LatencyHistogram detectSendLatency("conflict check -> alert send");
+LatencyHistogram sendReceiveLatency("alert send -> display print");
+LatencyHistogram endToEndLatency("END TO END: state -> display print");
+// Refresh loop timing against the 1 s radar period (measurement-only timer, never armed)
+ATCTimer displayTimer(0, 0);
+DeadlineMonitor displayDeadline("Display::readAndDisplay", displayTimer, 1000.0);
+std::atomic<bool> latencyDumpRequested(false);
+std::atomic<bool> shutdownRequested(false);
+
+void onSignal(int sig) {
+    if (sig != SIGUSR1) {
+        shutdownRequested = true;
+    }
+    latencyDumpRequested = true;
+}
+
+void recordAlertLatency(const latency_trace& trace, uint64_t printed) {
+    statePollLatency.recordInterval(trace.state, trace.poll);
+    pollPublishLatency.recordInterval(trace.poll, trace.publish);
+    publishReadLatency.recordInterval(trace.publish, trace.read);
+    readDetectLatency.recordInterval(trace.read, trace.detect);
+    detectSendLatency.recordInterval(trace.detect, trace.send);
+    sendReceiveLatency.recordInterval(trace.send, printed);
+    endToEndLatency.recordInterval(trace.state, printed);
+}
+
+void printLatencyReport() {
+    std::cout << "\n================= Sensor-to-Alert Latency =================\n";
+    LatencyHistogram::printHeader(std::cout);
+    statePollLatency.print(std::cout);
+    pollPublishLatency.print(std::cout);
+    publishReadLatency.print(std::cout);
+    readDetectLatency.print(std::cout);
+    detectSendLatency.print(std::cout);
+    sendReceiveLatency.print(std::cout);
+    endToEndLatency.print(std::cout);
+    displayDeadline.printStats();
+    ThreadProfiles::printStats(std::cout);
+    MemoryWarmup::printReport(std::cout);
+}
 int clamp(int val, int minVal, int maxVal) {
     if (val < minVal) return minVal;
     if (val > maxVal) return maxVal;
     return val;
 }
-struct PlanePair {
-    int plane1;
-    int plane2;
+// Cell width in characters: plane IDs are right-aligned in the first CELL_W-1 characters
+#define CELL_W 3
+
+// Header line, the GRID_H grid rows, then the controls line
+GridRenderer renderer(GRID_H + 2, GRID_W * CELL_W);
+
+// Part of the airspace shown in the grid. Slice 0 shows every altitude,
+// slice n > 0 shows MIN_Z + (n-1)*ALT_SLICE up to the next slice.
+struct Viewport {
+    double centerX = MAX_X / 2;
+    double centerY = MAX_Y / 2;
+    int zoom = 1;
+    int slice = 0;
+
+    double width() const { return MAX_X / zoom; }
+    double height() const { return MAX_Y / zoom; }
+    double minX() const { return centerX - width() / 2; }
+    double minY() const { return centerY - height() / 2; }
+    double minZ() const { return slice == 0 ? -1e12 : MIN_Z + (slice - 1) * ALT_SLICE; }
+    double maxZ() const { return slice == 0 ? 1e12 : MIN_Z + slice * ALT_SLICE; }
+
+    // Keep the viewport inside the airspace
+    void fit() {
+        centerX = std::min(std::max(centerX, width() / 2), MAX_X - width() / 2);
+        centerY = std::min(std::max(centerY, height() / 2), MAX_Y - height() / 2);
+    }
 };
-// Display planes in text grid
+
+// Latest frame and its index, shared by the refresh thread and the keyboard thread
+std::mutex viewMutex;
+Viewport view;
+std::vector<msg_plane_info> currentFrame;
+SpatialIndex frameIndex(MAX_X, MAX_Y, TILE_SIZE);
+std::vector<const msg_plane_info*> visible;  // Tracks inside the viewport, reused between draws
+
+// Conflicts currently open in ComputerSystem, kept from the alert transitions it sends.
+// ComputerSystem is the only conflict detector; the Display just shows its answer.
+std::map<std::pair<int, int>, msg_collision_alert> activeConflicts;
+std::set<int> planesInConflict;
+
+std::string formatKm(double meters) {
+    std::ostringstream out;
+    out.precision(1);
+    out << std::fixed << meters / 1000.0;
+    return out.str();
+}
+
+// Display the tracks inside the viewport in the text grid, sending only the cells that
+// changed since the last frame. Only the index tiles under the viewport are visited.
+// Caller holds viewMutex; fills `visible`.
 void drawGrid() {
-    std::vector<std::vector<std::string>> grid(GRID_H, std::vector<std::string>(GRID_W, " ."));
+    visible.clear();
+    frameIndex.query(view.minX(), view.minX() + view.width(), view.minY(), view.minY() + view.height(),
+                     view.minZ(), view.maxZ(), visible);
+
+    std::ostringstream header;
+    header << "Airspace: " << currentFrame.size() << " planes, " << visible.size() << " in view"
+           << " | X " << formatKm(view.minX()) << "-" << formatKm(view.minX() + view.width()) << " km"
+           << " Y " << formatKm(view.minY()) << "-" << formatKm(view.minY() + view.height()) << " km"
+           << " | zoom x" << view.zoom << " | " << activeConflicts.size() << " conflicts | tick " << TimeBase::tick() << " | alt ";
+    if (view.slice == 0) {
+        header << "all";
+    } else {
+        header << view.minZ() << "-" << view.maxZ();
+    }
+
+    renderer.clear();
+    renderer.put(0, 0, header.str());
+    renderer.put(GRID_H + 1, 0, "w/a/s/d pan  +/- zoom  [/] altitude slice  r reset  (+N: N planes in one cell, !: in conflict)");
 
-    for (int i = 0; i < shared_mem->count; ++i) {
-        auto& p = shared_mem->plane_data[i];
+    // Tracks per cell, so that shared cells show a count instead of hiding each other
+    static std::vector<int> cellCount(GRID_W * GRID_H);
+    static std::vector<const msg_plane_info*> cellPlane(GRID_W * GRID_H);
+    static std::vector<char> cellConflict(GRID_W * GRID_H);
+    std::fill(cellCount.begin(), cellCount.end(), 0);
+    std::fill(cellConflict.begin(), cellConflict.end(), 0);
 
+    for (const msg_plane_info* p : visible) {
         // Map world coordinates to grid
-        int gx = static_cast<int>(p.PositionX / MAX_X * GRID_W);
-        int gy = static_cast<int>(p.PositionY / MAX_Y * GRID_H);
+        int gx = static_cast<int>((p->PositionX - view.minX()) / view.width() * GRID_W);
+        int gy = static_cast<int>((p->PositionY - view.minY()) / view.height() * GRID_H);
 
         // Clamp
-        if (gx < 0) gx = 0;
-        if (gx >= GRID_W) gx = GRID_W - 1;
-        if (gy < 0) gy = 0;
-        if (gy >= GRID_H) gy = GRID_H - 1;
-
-        // Place plane ID in grid (convert int to string)
-        if (grid[GRID_H - 1 - gy][gx] != " .") {
-            grid[GRID_H - 1 - gy][gx] = "*"; // mark collision
-        } else {
-            grid[GRID_H - 1 - gy][gx] = std::to_string(p.id);
+        gx = clamp(gx, 0, GRID_W - 1);
+        gy = clamp(gy, 0, GRID_H - 1);
+
+        int cell = gy * GRID_W + gx;
+        cellCount[cell]++;
+        cellPlane[cell] = p;
+        if (planesInConflict.count(p->id)) {
+            cellConflict[cell] = 1;
         }
-
     }
 
-    // Print the grid
-    for (auto& row : grid) {
-        for (auto& cell : row) {
-            std::cout << cell << " ";
+    for (int gy = 0; gy < GRID_H; ++gy) {
+        int row = GRID_H - gy;  // Row 0 is the header, north is up
+        for (int gx = 0; gx < GRID_W; ++gx) {
+            int count = cellCount[gy * GRID_W + gx];
+            std::string cell;
+            const char mark = cellConflict[gy * GRID_W + gx] ? '!' : ' ';
+            if (count == 0) {
+                cell = " . ";
+            } else if (count > 1) {
+                cell = (count > 9 ? std::string("++") : "+" + std::to_string(count)) + mark;
+            } else {
+                std::string id = std::to_string(cellPlane[gy * GRID_W + gx]->id);
+                if (id.size() > CELL_W - 1) id = std::string(CELL_W - 1, '#');
+                cell = std::string(CELL_W - 1 - id.size(), ' ') + id + mark;
+            }
+            renderer.put(row, gx * CELL_W, cell);
         }
-        std::cout << "\n";
     }
+
+    renderer.present();
 }
 
+// Terminal settings to restore at exit
+struct termios savedTerminal;
+bool terminalSaved = false;
 
+void restoreTerminal() {
+    if (terminalSaved) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedTerminal);
+    }
+}
 
-// Thread to listen for collision warnings
-void listenForCollisions() {
-    name_attach_t* attach = name_attach(nullptr, DISPLAY_CHANNEL, 0);
-    if (!attach) {
-        std::cerr << "Display: name_attach failed\n";
+// Thread reading single key presses to move the viewport; redraws the last frame immediately
+void handleKeyboard() {
+    ThreadProfiles::apply("display.keyboard");
+    if (tcgetattr(STDIN_FILENO, &savedTerminal) == 0) {
+        struct termios raw = savedTerminal;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0) {
+            terminalSaved = true;
+            std::atexit(restoreTerminal);
+        }
+    }
+    if (!terminalSaved) {
+        std::cerr << "Display: stdin is not a terminal, viewport controls disabled\n";
         return;
     }
 
-    Message_inter_process msg;
-    while (true) {
-        int rcvid = MsgReceive(attach->chid, &msg, sizeof(msg), nullptr);
-        if (rcvid < 0) continue;
-
-        if (msg.type == MessageType::COLLISION_DETECTED) {
-            std::cout << "\n*** COLLISION WARNING ***\n";
-            int numPairs = msg.dataSize / sizeof(std::pair<int,int>);
-            auto pairs = reinterpret_cast<std::pair<int,int>*>(msg.data.data());
-            for (int i = 0; i < numPairs; i++) {
-                std::cout << "Planes " << pairs[i].first
-                          << " and " << pairs[i].second
-                          << " predicted to collide.\n";
-            }
-            std::cout << "*************************\n";
+    // Wakes up periodically to notice a shutdown
+    struct pollfd input = {STDIN_FILENO, POLLIN, 0};
+    char key;
+    while (!shutdownRequested) {
+        int ready = poll(&input, 1, 200);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready == 0) continue;
+        if (ready < 0 || read(STDIN_FILENO, &key, 1) != 1) break;
+        std::lock_guard<std::mutex> lock(viewMutex);
+        switch (key) {
+            case 'w': view.centerY += view.height() / 4; break;
+            case 's': view.centerY -= view.height() / 4; break;
+            case 'a': view.centerX -= view.width() / 4; break;
+            case 'd': view.centerX += view.width() / 4; break;
+            case '+':
+            case '=': view.zoom = std::min(view.zoom * 2, MAX_ZOOM); break;
+            case '-': view.zoom = std::max(view.zoom / 2, 1); break;
+            case '[': view.slice = (view.slice + ALT_SLICES) % (ALT_SLICES + 1); break;
+            case ']': view.slice = (view.slice + 1) % (ALT_SLICES + 1); break;
+            case 'r': view = Viewport(); break;
+            default: continue;
         }
-
-        MsgReply(rcvid, EOK, nullptr, 0);
+        view.fit();
+        drawGrid();
     }
-
-    name_detach(attach, 0);
 }
 
-void collisionIPCServer() {
-    name_attach_t* attach = name_attach(nullptr, COLLISION_CHANNEL, 0);
-    if (!attach) {
-        std::cerr << "IPC Server: name_attach failed\n";
-        return;
+// Apply a batch of alert transitions to the conflict set and mark the aircraft on the grid
+void updateConflicts(const msg_collision_alert* alerts, int numAlerts) {
+    std::lock_guard<std::mutex> lock(viewMutex);
+    for (int i = 0; i < numAlerts; i++) {
+        std::pair<int, int> key(alerts[i].plane1, alerts[i].plane2);
+        if (alerts[i].state == AlertState::CLEARED) {
+            activeConflicts.erase(key);
+        } else {
+            activeConflicts[key] = alerts[i];
+        }
     }
-
-    Message_inter_process msg;
-    while (true) {
-        int rcvid = MsgReceive(attach->chid, &msg, sizeof(msg), nullptr);
-        if (rcvid < 0) continue;
-
-        MsgReply(rcvid, EOK, nullptr, 0);
+    planesInConflict.clear();
+    for (auto& entry : activeConflicts) {
+        planesInConflict.insert(entry.first.first);
+        planesInConflict.insert(entry.first.second);
+    }
+    if (!currentFrame.empty()) {
+        drawGrid();
     }
+}
 
-    name_detach(attach, 0);
+// Replace the conflict set with a complete ALERT_SNAPSHOT. Pairs the transitions had
+// not shown (Display started late, alert lost) and pairs no longer active are reported.
+void replaceConflicts(const std::vector<msg_alert_entry>& active, std::ostringstream& report) {
+    std::lock_guard<std::mutex> lock(viewMutex);
+    std::map<std::pair<int, int>, msg_collision_alert> next;
+    for (const msg_alert_entry& entry : active) {
+        std::pair<int, int> key(entry.plane1, entry.plane2);
+        auto it = activeConflicts.find(key);
+        if (it != activeConflicts.end()) {
+            next[key] = it->second;
+        } else {
+            next[key] = msg_collision_alert{entry.plane1, entry.plane2, entry.state, 0.0, 0.0, {}};
+            report << "Conflict in progress: planes " << entry.plane1 << " and " << entry.plane2
+                   << (entry.state == AlertState::ESCALATED ? " (imminent).\n" : ".\n");
+        }
+    }
+    for (const auto& entry : activeConflicts) {
+        if (next.find(entry.first) == next.end()) {
+            report << "Conflict cleared: planes " << entry.first.first << " and " << entry.first.second << ".\n";
+        }
+    }
+    activeConflicts.swap(next);
+    planesInConflict.clear();
+    for (auto& entry : activeConflicts) {
+        planesInConflict.insert(entry.first.first);
+        planesInConflict.insert(entry.first.second);
+    }
+    if (!currentFrame.empty()) {
+        drawGrid();
+    }
 }
 
-void sendCollisionAlert(int planeA, int planeB) {
-    int coid = name_open(COLLISION_CHANNEL, 0);
-    if (coid == -1) {
-        std::cerr << "Display: Failed to connect to collision channel\n";
+// Thread to listen for collision warnings, until the server is detached at shutdown
+void listenForCollisions(IpcServer& server) {
+    ThreadProfiles::apply("display.alerts");
+    MemoryWarmup::prefaultStack();
+    if (!server.isAttached()) {
+        std::cerr << "Display: attach failed\n";
         return;
     }
 
-    PlanePair pair{planeA, planeB};
-    Message_inter_process msg;
-    msg.type = MessageType::COLLISION_DETECTED;
-    msg.dataSize = sizeof(pair);
-    memcpy(msg.data.data(), &pair, sizeof(pair));
+    Message msg;
+    // ALERT_SNAPSHOT being assembled; applied once its last part arrives in order
+    std::vector<msg_alert_entry> snapshotAlerts;
+    uint32_t snapshotNumber = 0;
+    int nextSnapshotPart = -1;  // -1: waiting for the first part of a snapshot
+    while (true) {
+        size_t received = 0;
+        int rcvid = server.receive(&msg, sizeof(msg), received);
+        if (rcvid < 0) {
+            if (errno == EINTR) continue;
+            if (!shutdownRequested) {
+                std::cerr << "Display: receive failed: " << strerror(errno) << ", no more collision alerts\n";
+            }
+            break;
+        }
+        if (!msg.valid(received)) {
+            server.error(rcvid, EPROTO);
+            continue;
+        }
 
-    MsgSend(coid, &msg, sizeof(msg), nullptr, 0);
+        if (msg.header.type == MessageType::COLLISION_DETECTED) {
+            // ComputerSystem only sends alert state transitions
+            int numAlerts = static_cast<int>(msg.count<msg_collision_alert>());
+            const msg_collision_alert* alerts = msg.get<msg_collision_alert>();
+            updateConflicts(alerts, numAlerts);
+            for (int i = 0; i < numAlerts; i++) {
+                const msg_collision_alert& a = alerts[i];
+                switch (a.state) {
+                    case AlertState::NEW:
+                        std::cout << "\n*** COLLISION WARNING ***\n"
+                                  << "Planes " << a.plane1 << " and " << a.plane2
+                                  << " predicted within " << a.missDistance << " m in "
+                                  << a.timeToClosestApproach << " s.\n"
+                                  << "*************************\n";
+                        recordAlertLatency(a.trace, TimeBase::nowNs());
+                        break;
+                    case AlertState::ESCALATED:
+                        std::cout << "\n!!! COLLISION IMMINENT !!!\n"
+                                  << "Planes " << a.plane1 << " and " << a.plane2
+                                  << " closest approach " << a.missDistance << " m in "
+                                  << a.timeToClosestApproach << " s.\n"
+                                  << "!!!!!!!!!!!!!!!!!!!!!!!!!\n";
+                        recordAlertLatency(a.trace, TimeBase::nowNs());
+                        break;
+                    case AlertState::CLEARED:
+                        std::cout << "Conflict cleared: planes " << a.plane1 << " and " << a.plane2 << ".\n";
+                        break;
+                    default:
+                        break;
+                }
+            }
+        } else if (msg.header.type == MessageType::ALERT_SNAPSHOT) {
+            const msg_alert_snapshot* part = msg.get<msg_alert_snapshot>();
+            if (!part || part->count < 0 || part->count > ALERT_SNAPSHOT_PART_ALERTS) {
+                server.error(rcvid, EPROTO);
+                continue;
+            }
+            if (part->part == 0) {
+                snapshotAlerts.clear();
+                snapshotNumber = part->snapshot;
+                nextSnapshotPart = 0;
+            }
+            if (part->snapshot == snapshotNumber && part->part == nextSnapshotPart) {
+                snapshotAlerts.insert(snapshotAlerts.end(), part->alerts, part->alerts + part->count);
+                nextSnapshotPart++;
+                if (nextSnapshotPart == part->parts) {
+                    std::ostringstream report;
+                    replaceConflicts(snapshotAlerts, report);
+                    std::cout << report.str() << std::flush;
+                    nextSnapshotPart = -1;
+                }
+            } else {
+                // A part went missing: wait for the next snapshot
+                nextSnapshotPart = -1;
+            }
+        }
 
-    close(coid);
+        server.reply(rcvid, EOK);
+    }
 }
 
-void checkAndNotifyCollisions() {
-    for (int i = 0; i < shared_mem->count; ++i) {
-        auto& p1 = shared_mem->plane_data[i];
-        for (int j = i + 1; j < shared_mem->count; ++j) {
-            auto& p2 = shared_mem->plane_data[j];
-
-            // Simple proximity check (tweak thresholds as needed)
-            if (std::abs(p1.PositionX - p2.PositionX) < 1000 &&
-                std::abs(p1.PositionY - p2.PositionY) < 1000 &&
-                std::abs(p1.PositionZ - p2.PositionZ) < 500) {
-
-                // Print to console
-                std::cout << "\n*** COLLISION ALERT! ***\n";
-                std::cout << "Planes " << p1.id << " and " << p2.id
-                          << " \nCOLLISION!\n";
-                std::cout << "************************\n";
-
-                // Send IPC message
-                sendCollisionAlert(p1.id, p2.id);
-            }
+// Block until the Radar publishes a new generation, then copy the frame out under frame_mutex.
+// Returns false on timeout (no frame published).
+bool waitForFrame(uint64_t& lastGeneration, std::vector<msg_plane_info>& frame) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += 2;
+
+    pthread_mutex_lock(&shared_mem->frame_mutex);
+    while (shared_mem->generation == lastGeneration) {
+        if (pthread_cond_timedwait(&shared_mem->frame_cond, &shared_mem->frame_mutex, &deadline) == ETIMEDOUT) {
+            pthread_mutex_unlock(&shared_mem->frame_mutex);
+            return false;
         }
     }
+    lastGeneration = shared_mem->generation;
+    frame.assign(shared_mem->plane_data, shared_mem->plane_data + (shared_mem->is_empty.load() ? 0 : shared_mem->count));
+    pthread_mutex_unlock(&shared_mem->frame_mutex);
+    return true;
 }
 
-// Thread to periodically read shared memory and draw the grid
+// Thread that redraws the grid each time the Radar publishes a frame, until a shutdown is requested
 void readAndDisplay() {
+    ThreadProfiles::apply("display.render");
+    MemoryWarmup::prefaultStack();
+    uint64_t lastGeneration = 0;
+    // Swapped with currentFrame each redraw: both get room for a full frame up front
+    std::vector<msg_plane_info> frame;
+    MemoryWarmup::prefault(frame, SHARED_MEMORY_MAX_PLANES);
+    {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        MemoryWarmup::prefault(currentFrame, SHARED_MEMORY_MAX_PLANES);
+        MemoryWarmup::prefault(visible, SHARED_MEMORY_MAX_PLANES);
+    }
     while (true) {
-        if (shared_mem->count == 0) {
-            std::cout << "No planes in airspace.";
-        } else {
+        if (latencyDumpRequested.exchange(false)) {
+            printLatencyReport();
+        }
+        if (shutdownRequested) {
+            break;
+        }
+        if (!waitForFrame(lastGeneration, frame)) {
+            continue;
+        }
+        displayDeadline.release();
+        std::ostringstream info;
+        {
+            // An empty frame is drawn too, so that the last aircraft leave the grid
+            std::lock_guard<std::mutex> lock(viewMutex);
+            currentFrame.swap(frame);
+            frameIndex.build(currentFrame);
             drawGrid();
 
-            std::cout << "Planes info:\n";
-            for (int i = 0; i < shared_mem->count; i++) {
-                auto& p = shared_mem->plane_data[i];
-                std::cout << "Plane " << p.id
-                          << " Pos(" << p.PositionX << "," << p.PositionY << "," << p.PositionZ << ")"
-                          << " Vel(" << p.VelocityX << "," << p.VelocityY << "," << p.VelocityZ << ")\n";
+            // Plane list of the tracks in view goes to the scrolling area below the grid, as one write
+            if (currentFrame.empty()) {
+                info << "No planes in airspace.\n";
+            } else {
+                info << "Planes info (" << visible.size() << " in view):\n";
+            }
+            for (const msg_plane_info* p : visible) {
+                info << "Plane " << p->id
+                     << " Pos(" << p->PositionX << "," << p->PositionY << "," << p->PositionZ << ")"
+                     << " Vel(" << p->VelocityX << "," << p->VelocityY << "," << p->VelocityZ << ")\n";
             }
-            checkAndNotifyCollisions();
         }
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        std::cout << info.str() << std::flush;
+        displayDeadline.complete();
     }
 }
 
 int main() {
+    // Scheduling policy, priority and CPUs of each thread role (threads.conf)
+    ThreadProfiles::loadDefault();
+    // Warm phase: everything mapped from here on stays resident (see MemoryWarmup.h)
+    MemoryWarmup::lockProcessMemory();
+
     // Open shared memory
     int fd = shm_open(SHM_NAME, O_RDWR, 0666);
     if (fd < 0) {
@@ -191,20 +500,33 @@ int main() {
         return 1;
     }
 
-    shared_mem = (SharedMemory*)mmap(nullptr, SHARED_MEMORY_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // Locked and pre-faulted (huge pages where supported)
+    shared_mem = (SharedMemory*)MemoryWarmup::mapShared(fd, SHARED_MEMORY_SIZE, PROT_READ | PROT_WRITE);
     if (shared_mem == MAP_FAILED) {
         std::cerr << "Display: mmap failed\n";
         return 1;
     }
 
     std::cout << "Display: Shared memory mapped successfully.\n";
+    if (!TimeBase::attach()) {
+        std::cerr << "Display: time base " << TIME_BASE_SHM_NAME << " not available: using local time\n";
+    }
+
+    // Latency report on demand (SIGUSR1) and on shutdown (SIGINT/SIGTERM)
+    std::signal(SIGUSR1, onSignal);
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
 
     // Start threads
+    IpcServer alertServer(DISPLAY_CHANNEL);
     std::thread t1(readAndDisplay);
-    std::thread t2(listenForCollisions);
-    std::thread t3(checkAndNotifyCollisions);
+    std::thread t2(listenForCollisions, std::ref(alertServer));
+    std::thread t3(handleKeyboard);
 
+    // The render thread returns on SIGINT/SIGTERM, after the latency report;
+    // detaching the channel unblocks the alert listener
     t1.join();
+    alertServer.detach();
     t2.join();
     t3.join();
 
@@ -0,0 +1,93 @@
+#include "GridRenderer.h"
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <unistd.h>
+
+GridRenderer::GridRenderer(int rows, int cols)
+	: rows(rows), cols(cols), current(rows * cols, ' '), previous(rows * cols, ' ') {
+	out.reserve(rows * (cols + 16) + 64);
+}
+
+GridRenderer::~GridRenderer() {
+	// Restore the full-screen scroll region
+	const char reset[] = "\x1b[r";
+	ssize_t ignored = write(STDOUT_FILENO, reset, sizeof(reset) - 1);
+	(void)ignored;
+}
+
+void GridRenderer::clear() {
+	std::memset(current.data(), ' ', current.size());
+}
+
+void GridRenderer::put(int row, int col, const std::string& text) {
+	if (row < 0 || row >= rows || col >= cols) {
+		return;
+	}
+	for (size_t i = 0; i < text.size(); ++i) {
+		int c = col + static_cast<int>(i);
+		if (c < 0) continue;
+		if (c >= cols) break;
+		current[row * cols + c] = text[i];
+	}
+}
+
+char GridRenderer::at(int row, int col) const {
+	return current[row * cols + col];
+}
+
+// ESC[row;colH, 1-based
+void GridRenderer::appendCursor(int row, int col) {
+	char seq[32];
+	int len = snprintf(seq, sizeof(seq), "\x1b[%d;%dH", row + 1, col + 1);
+	out.append(seq, len);
+}
+
+void GridRenderer::present() {
+	out.clear();
+
+	if (firstFrame) {
+		// Clear the screen, keep the canvas out of the scroll region, draw everything
+		char region[32];
+		int len = snprintf(region, sizeof(region), "\x1b[%d;r", rows + 2);
+		out.append("\x1b[2J");
+		out.append(region, len);
+		for (int r = 0; r < rows; ++r) {
+			appendCursor(r, 0);
+			out.append(&current[r * cols], cols);
+		}
+		appendCursor(rows + 1, 0);  // Start of the scrolling output area
+	} else {
+		out.append("\x1b" "7");  // Save the cursor of the scrolling output area
+		for (int r = 0; r < rows; ++r) {
+			const char* cur = &current[r * cols];
+			const char* prev = &previous[r * cols];
+			int c = 0;
+			while (c < cols) {
+				if (cur[c] == prev[c]) {
+					++c;
+					continue;
+				}
+				// Emit the whole run of changed characters after one cursor move
+				int start = c;
+				while (c < cols && cur[c] != prev[c]) ++c;
+				appendCursor(r, start);
+				out.append(cur + start, c - start);
+			}
+		}
+		out.append("\x1b" "8");  // Back to the scrolling output area
+	}
+
+	// Anything already buffered by std::cout must reach the terminal first
+	std::cout.flush();
+	size_t written = 0;
+	while (written < out.size()) {
+		ssize_t n = write(STDOUT_FILENO, out.data() + written, out.size() - written);
+		if (n <= 0) break;
+		written += n;
+	}
+	frameBytes = written;
+
+	std::memcpy(previous.data(), current.data(), current.size());
+	firstFrame = false;
+}
@@ -0,0 +1,57 @@
+/*
+ * The GridRenderer class draws a fixed-size character canvas at the top of the
+ * terminal and only sends what changed since the previous frame.
+ *
+ * *****Frame buffers*****:
+ * The current and previous frames are flat character buffers (rows x cols).
+ * Callers clear() the current frame, put() text into it, then present().
+ *
+ * *****Output*****:
+ * present() compares both buffers, and for every run of changed characters
+ * appends a cursor-addressing escape sequence followed by the new characters
+ * to one output buffer, which is sent with a single write(). The first frame
+ * is drawn in full. The terminal scroll region is set below the canvas so the
+ * regular std::cout output (alerts, plane list) scrolls without overwriting it.
+ */
+
+#ifndef GRIDRENDERER_H_
+#define GRIDRENDERER_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+class GridRenderer {
+public:
+	GridRenderer(int rows, int cols);
+	~GridRenderer();
+
+	int getRows() const { return rows; }
+	int getCols() const { return cols; }
+
+	// Reset the current frame to blanks
+	void clear();
+
+	// Write text at (row, col) of the current frame, clipped to the canvas
+	void put(int row, int col, const std::string& text);
+
+	// Character at (row, col) of the current frame
+	char at(int row, int col) const;
+
+	// Send the differences with the previous frame in a single write
+	void present();
+
+	size_t lastFrameBytes() const { return frameBytes; }
+
+private:
+	void appendCursor(int row, int col);
+
+	int rows, cols;
+	std::vector<char> current;
+	std::vector<char> previous;
+	std::string out;          // Reused output buffer
+	bool firstFrame = true;
+	size_t frameBytes = 0;    // Bytes written by the last present()
+};
+
+#endif /* GRIDRENDERER_H_ */
@@ -0,0 +1,50 @@
+#include "SpatialIndex.h"
+#include <cmath>
+
+SpatialIndex::SpatialIndex(double maxX, double maxY, double tileSize)
+	: tileSize(tileSize),
+	  tilesX(static_cast<int>(std::ceil(maxX / tileSize))),
+	  tilesY(static_cast<int>(std::ceil(maxY / tileSize))),
+	  tiles(tilesX * tilesY) {}
+
+// Tracks outside the airspace are kept in the border tiles
+int SpatialIndex::tileX(double x) const {
+	int t = static_cast<int>(std::floor(x / tileSize));
+	return t < 0 ? 0 : (t >= tilesX ? tilesX - 1 : t);
+}
+
+int SpatialIndex::tileY(double y) const {
+	int t = static_cast<int>(std::floor(y / tileSize));
+	return t < 0 ? 0 : (t >= tilesY ? tilesY - 1 : t);
+}
+
+void SpatialIndex::build(const std::vector<msg_plane_info>& newFrame) {
+	for (std::vector<int>& tile : tiles) {
+		tile.clear();  // Keeps capacity for the next frame
+	}
+	frame = &newFrame;
+	for (size_t i = 0; i < newFrame.size(); ++i) {
+		tiles[tileY(newFrame[i].PositionY) * tilesX + tileX(newFrame[i].PositionX)].push_back(static_cast<int>(i));
+	}
+}
+
+void SpatialIndex::query(double minX, double maxX, double minY, double maxY, double minZ, double maxZ,
+                         std::vector<const msg_plane_info*>& out) const {
+	if (!frame) {
+		return;
+	}
+	int x0 = tileX(minX), x1 = tileX(maxX);
+	int y0 = tileY(minY), y1 = tileY(maxY);
+	for (int ty = y0; ty <= y1; ++ty) {
+		for (int tx = x0; tx <= x1; ++tx) {
+			for (int index : tiles[ty * tilesX + tx]) {
+				const msg_plane_info& p = (*frame)[index];
+				if (p.PositionX >= minX && p.PositionX < maxX &&
+				    p.PositionY >= minY && p.PositionY < maxY &&
+				    p.PositionZ >= minZ && p.PositionZ < maxZ) {
+					out.push_back(&p);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,38 @@
+/*
+ * The SpatialIndex class buckets the tracks of one frame into a uniform grid of
+ * square tiles covering the airspace, so that a box query only visits the tiles
+ * it overlaps instead of every track.
+ *
+ * build() is O(number of tracks) and reuses the tile vectors between frames.
+ * query() costs O(tiles overlapped + tracks in those tiles), i.e. proportional
+ * to what is inside the viewport, not to the total traffic.
+ */
+
+#ifndef SPATIALINDEX_H_
+#define SPATIALINDEX_H_
+
+#include <vector>
+#include "Msg_structs.h"
+
+class SpatialIndex {
+public:
+	SpatialIndex(double maxX, double maxY, double tileSize);
+
+	// Index a new frame; the frame must outlive the queries
+	void build(const std::vector<msg_plane_info>& frame);
+
+	// Append to `out` every track with minX <= x < maxX, minY <= y < maxY and minZ <= z < maxZ
+	void query(double minX, double maxX, double minY, double maxY, double minZ, double maxZ,
+	           std::vector<const msg_plane_info*>& out) const;
+
+private:
+	int tileX(double x) const;
+	int tileY(double y) const;
+
+	double tileSize;
+	int tilesX, tilesY;
+	std::vector<std::vector<int>> tiles;  // Track indexes per tile, row-major
+	const std::vector<msg_plane_info>* frame = nullptr;
+};
+
+#endif /* SPATIALINDEX_H_ */
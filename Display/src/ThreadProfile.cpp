@@ -0,0 +1,307 @@
+#include "ThreadProfile.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#ifdef __QNX__
+#include <sys/neutrino.h>
+#else
+#include <sys/syscall.h>
+#endif
+
+namespace {
+
+// One thread that called apply()
+struct ThreadRecord {
+	std::string role;
+	int tid;
+	bool applied;
+	bool exited;
+	long voluntary;
+	long involuntary;
+	long migrations;
+	int lastCpu;  // Last sampled CPU (QNX)
+};
+
+std::mutex registryMutex;
+std::map<std::string, ThreadProfile> profiles;
+std::list<ThreadRecord> records;      // Stable addresses for `current`
+std::set<std::string> reportedRoles;  // Roles whose profile failed, reported once
+
+thread_local ThreadRecord* current = nullptr;
+
+int currentTid() {
+#ifdef __QNX__
+	return static_cast<int>(pthread_self());
+#else
+	return static_cast<int>(syscall(SYS_gettid));
+#endif
+}
+
+#ifndef __QNX__
+// Value of a "key: value" line of a /proc file, -1 if missing
+long readProcField(const std::string& path, const std::string& key) {
+	std::ifstream file(path);
+	std::string line;
+	while (std::getline(file, line)) {
+		if (line.compare(0, key.size(), key) != 0 || line.size() == key.size()
+		    || (line[key.size()] != ':' && line[key.size()] != ' ' && line[key.size()] != '\t')) {
+			continue;
+		}
+		size_t colon = line.find(':', key.size());
+		if (colon != std::string::npos) {
+			return std::strtol(line.c_str() + colon + 1, nullptr, 10);
+		}
+	}
+	return -1;
+}
+
+// The kernel keeps the counters; they can be read from any thread while the thread lives
+void readCounters(ThreadRecord& record) {
+	std::string base = "/proc/self/task/" + std::to_string(record.tid);
+	record.voluntary = readProcField(base + "/status", "voluntary_ctxt_switches");
+	record.involuntary = readProcField(base + "/status", "nonvoluntary_ctxt_switches");
+	record.migrations = readProcField(base + "/sched", "se.nr_migrations");
+}
+#endif
+
+// Final snapshot when the thread exits, before its counters disappear
+struct ExitSnapshot {
+	~ExitSnapshot() {
+		std::lock_guard<std::mutex> lock(registryMutex);
+		if (!current) {
+			return;
+		}
+#ifndef __QNX__
+		readCounters(*current);
+#endif
+		current->exited = true;
+		current = nullptr;
+	}
+};
+
+bool parsePolicy(const std::string& name, int& policy) {
+	if (name == "other") policy = SCHED_OTHER;
+	else if (name == "fifo") policy = SCHED_FIFO;
+	else if (name == "rr") policy = SCHED_RR;
+	else return false;
+	return true;
+}
+
+// "any" or a list such as 0,2-3
+bool parseCpus(const std::string& text, std::vector<int>& cpus) {
+	cpus.clear();
+	if (text == "any") {
+		return true;
+	}
+	std::istringstream in(text);
+	std::string item;
+	while (std::getline(in, item, ',')) {
+		int first, last;
+		char dash;
+		std::istringstream range(item);
+		if (!(range >> first) || first < 0) return false;
+		last = first;
+		if (range >> dash) {
+			if (dash != '-' || !(range >> last) || last < first) return false;
+		}
+		for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+	}
+	return !cpus.empty();
+}
+
+bool setAffinity(const std::vector<int>& cpus, std::string& failure) {
+#ifdef __QNX__
+	unsigned runmask = 0;
+	for (int cpu : cpus) {
+		if (cpu >= 32) {
+			failure = "CPU " + std::to_string(cpu) + " out of range";
+			return false;
+		}
+		runmask |= 1u << cpu;
+	}
+	if (ThreadCtl(_NTO_TCTL_RUNMASK, (void*)(uintptr_t)runmask) == -1) {
+		failure = std::string("affinity: ") + strerror(errno);
+		return false;
+	}
+#else
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int cpu : cpus) {
+		if (cpu >= CPU_SETSIZE) {
+			failure = "CPU " + std::to_string(cpu) + " out of range";
+			return false;
+		}
+		CPU_SET(cpu, &set);
+	}
+	int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+	if (rc != 0) {
+		failure = std::string("affinity: ") + strerror(rc);
+		return false;
+	}
+#endif
+	return true;
+}
+
+void addCount(long& total, long value) {
+	if (value >= 0) {
+		total = (total < 0 ? 0 : total) + value;
+	}
+}
+
+} // namespace
+
+int ThreadProfiles::load(const std::string& path) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		return -1;
+	}
+
+	std::map<std::string, ThreadProfile> loaded;
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		++lineNumber;
+		line = line.substr(0, line.find('#'));
+		std::istringstream in(line);
+		ThreadProfile profile;
+		std::string policy, cpus;
+		if (!(in >> profile.role)) {
+			continue;  // Blank or comment
+		}
+		if (!(in >> policy >> profile.priority >> cpus) || !parsePolicy(policy, profile.policy)) {
+			std::cerr << "ThreadProfiles: " << path << ":" << lineNumber << ": expected <role> <other|fifo|rr> <priority> <cpus>\n";
+			continue;
+		}
+		if (profile.priority < sched_get_priority_min(profile.policy) || profile.priority > sched_get_priority_max(profile.policy)) {
+			std::cerr << "ThreadProfiles: " << path << ":" << lineNumber << ": priority " << profile.priority
+			          << " out of range for " << policy << "\n";
+			continue;
+		}
+		if (!parseCpus(cpus, profile.cpus)) {
+			std::cerr << "ThreadProfiles: " << path << ":" << lineNumber << ": bad CPU list '" << cpus << "'\n";
+			continue;
+		}
+		loaded[profile.role] = profile;
+	}
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	profiles.swap(loaded);
+	std::cout << "ThreadProfiles: " << profiles.size() << " roles loaded from " << path << "\n";
+	return static_cast<int>(profiles.size());
+}
+
+int ThreadProfiles::loadDefault() {
+	const char* path = std::getenv("ATC_THREAD_PROFILES");
+	int roles = load(path ? path : THREAD_PROFILE_FILE);
+	if (roles == -1 && path) {
+		std::cerr << "ThreadProfiles: cannot open " << path << ", using default scheduling\n";
+	}
+	return roles;
+}
+
+bool ThreadProfiles::apply(const std::string& role) {
+	static thread_local ExitSnapshot exitSnapshot;  // Constructed for this thread on first use
+
+	ThreadProfile profile;
+	bool found;
+	{
+		std::lock_guard<std::mutex> lock(registryMutex);
+		auto it = profiles.find(role);
+		found = it != profiles.end();
+		if (found) profile = it->second;
+	}
+
+	bool applied = true;
+	std::string failure;
+	if (found) {
+		if (!profile.cpus.empty() && !setAffinity(profile.cpus, failure)) {
+			applied = false;
+		}
+		// The scheduling is applied even if the pinning failed
+		sched_param param;
+		std::memset(&param, 0, sizeof(param));
+		param.sched_priority = profile.priority;
+		int rc = pthread_setschedparam(pthread_self(), profile.policy, &param);
+		if (rc != 0) {
+			applied = false;
+			failure = std::string("scheduling: ") + strerror(rc);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	records.push_back(ThreadRecord{role, currentTid(), applied, false, -1, -1, -1, -1});
+	current = &records.back();
+#ifdef __QNX__
+	current->migrations = 0;
+	current->lastCpu = SchedGetCpuNum();
+#endif
+	if (!applied && reportedRoles.insert(role).second) {
+		std::cerr << "ThreadProfiles: cannot fully apply the profile of '" << role << "' (" << failure << ")\n";
+	}
+	return applied;
+}
+
+void ThreadProfiles::sample() {
+#ifdef __QNX__
+	std::lock_guard<std::mutex> lock(registryMutex);
+	if (!current) {
+		return;
+	}
+	int cpu = SchedGetCpuNum();
+	if (cpu != current->lastCpu) {
+		current->migrations++;
+		current->lastCpu = cpu;
+	}
+#endif
+}
+
+std::vector<ThreadRoleStats> ThreadProfiles::getStats() {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	std::map<std::string, ThreadRoleStats> byRole;
+	for (ThreadRecord& record : records) {
+#ifndef __QNX__
+		if (!record.exited) {
+			readCounters(record);
+		}
+#endif
+		ThreadRoleStats& stats = byRole[record.role];
+		stats.role = record.role;
+		stats.threads++;
+		if (!record.applied) stats.notApplied++;
+		addCount(stats.voluntarySwitches, record.voluntary);
+		addCount(stats.involuntarySwitches, record.involuntary);
+		addCount(stats.migrations, record.migrations);
+		if (record.migrations > stats.maxMigrations) stats.maxMigrations = record.migrations;
+	}
+
+	std::vector<ThreadRoleStats> result;
+	for (const auto& entry : byRole) {
+		result.push_back(entry.second);
+	}
+	return result;
+}
+
+void ThreadProfiles::printStats(std::ostream& os) {
+	auto count = [](long value) { return value < 0 ? std::string("n/a") : std::to_string(value); };
+	os << "\n================= Thread Isolation =================\n"
+	   << std::left << std::setw(20) << "Role" << std::right
+	   << std::setw(8) << "threads" << std::setw(9) << "failed"
+	   << std::setw(12) << "vol cs" << std::setw(12) << "invol cs"
+	   << std::setw(12) << "migrations" << std::setw(12) << "max/thread" << "\n";
+	for (const ThreadRoleStats& stats : getStats()) {
+		os << std::left << std::setw(20) << stats.role << std::right
+		   << std::setw(8) << stats.threads << std::setw(9) << stats.notApplied
+		   << std::setw(12) << count(stats.voluntarySwitches) << std::setw(12) << count(stats.involuntarySwitches)
+		   << std::setw(12) << count(stats.migrations) << std::setw(12) << count(stats.maxMigrations) << "\n";
+	}
+}
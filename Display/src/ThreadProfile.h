@@ -0,0 +1,85 @@
+/*
+ * The ThreadProfiles class assigns a scheduling policy, a priority and a CPU
+ * affinity to each named thread role, and reports how well each role stayed
+ * on its CPUs.
+ *
+ * *****Configuration file*****:
+ * One role per line, '#' starts a comment:
+ *
+ *     # role            policy  priority  cpus
+ *     radar.poll        fifo    60        1
+ *     aircraft          other   0         2-3
+ *
+ * policy is other, fifo or rr; priority must be valid for the policy
+ * (0 for other); cpus is "any" or a list such as 0,2-3. The file is
+ * THREAD_PROFILE_FILE in the working directory unless the ATC_THREAD_PROFILES
+ * environment variable names another one. Without a file every thread keeps
+ * the default scheduling.
+ *
+ * *****Applying*****:
+ * Each thread calls apply(role) first thing. Roles missing from the file are
+ * left unchanged. A profile that cannot be applied (e.g. a real-time policy
+ * without the privilege for it, or a CPU the machine does not have) is
+ * reported once per role; the thread keeps whatever part of it succeeded.
+ *
+ *   Role                QNX                         Linux
+ *   policy, priority    pthread_setschedparam       pthread_setschedparam
+ *   cpus                ThreadCtl(_NTO_TCTL_RUNMASK) pthread_setaffinity_np
+ *
+ * *****Isolation statistics*****:
+ * Every thread that called apply() is counted until it exits, and the totals
+ * are kept per role:
+ * Linux: voluntary and involuntary context switches and CPU migrations, read
+ * from /proc/self/task/<tid> (migrations need a kernel with scheduler debug
+ * info, otherwise they show as n/a).
+ * QNX: migrations are sampled with SchedGetCpuNum() at each sample() (called
+ * by DeadlineMonitor::complete()); context switch counts need the kernel
+ * tracer and show as n/a.
+ */
+
+#ifndef THREADPROFILE_H_
+#define THREADPROFILE_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#define THREAD_PROFILE_FILE "threads.conf"
+
+struct ThreadProfile {
+	std::string role;
+	int policy;
+	int priority;
+	std::vector<int> cpus;  // Empty: any CPU
+};
+
+// Totals for the threads of one role; -1 when not available on this system
+struct ThreadRoleStats {
+	std::string role;
+	int threads = 0;
+	int notApplied = 0;               // Threads whose profile failed in part or whole
+	long voluntarySwitches = -1;
+	long involuntarySwitches = -1;
+	long migrations = -1;
+	long maxMigrations = -1;          // Most migrations of any one thread
+};
+
+class ThreadProfiles {
+public:
+	// Read a profile file; returns the number of roles, or -1 if it cannot be opened
+	static int load(const std::string& path);
+	// Load ATC_THREAD_PROFILES, or THREAD_PROFILE_FILE if it is not set
+	static int loadDefault();
+
+	// Apply the profile of `role` to the calling thread and count it in the statistics
+	static bool apply(const std::string& role);
+
+	// Calling thread: record the CPU it runs on (migration sampling on QNX)
+	static void sample();
+
+	static std::vector<ThreadRoleStats> getStats();
+	static void printStats(std::ostream& os);
+};
+
+#endif /* THREADPROFILE_H_ */
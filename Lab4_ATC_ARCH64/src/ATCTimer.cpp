@@ -1,7 +1,59 @@
 #include "ATCTimer.h"
+#ifndef __QNX__
+#include <sys/timerfd.h>
+#endif
+
+// Convert nanoseconds to a timespec
+static struct timespec toTimespec(uint64_t ns) {
+	struct timespec ts;
+	ts.tv_sec = ns / 1000000000ULL;
+	ts.tv_nsec = ns % 1000000000ULL;
+	return ts;
+}
 
 // Constructor to initialize timer with seconds and milliseconds
-ATCTimer::ATCTimer(uint32_t sec, uint32_t msec) {
+ATCTimer::ATCTimer(uint32_t sec, uint32_t msec)
+	: period_ns(0), next_deadline_ns(0), overruns(0), timer_created(false) {
+#ifdef __QNX__
+	channel_id = -1;
+	connection_id = -1;
+	// Get the system's cycles per second for time calculations
+	cycles_per_sec = SYSPAGE_ENTRY(qtime)->cycles_per_sec;
+	tick_cycles = tock_cycles = 0;
+#else
+	timer_fd = -1;
+	tick_ns = tock_ns = 0;
+#endif
+
+	// Set up the timer specifications (interval and initial expiration)
+	setTimerSpecification(sec,1000000* msec); //converting ms to ns
+}
+
+ATCTimer::~ATCTimer() {
+	if (!timer_created) {
+		return;
+	}
+#ifdef __QNX__
+	timer_delete(timer_id);
+	ConnectDetach(connection_id);
+	ChannelDestroy(channel_id);
+#else
+	close(timer_fd);
+#endif
+}
+
+uint64_t ATCTimer::nowNs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Create the kernel timer the first time a period is set, so measurement-only timers cost nothing
+bool ATCTimer::createTimer() {
+	if (timer_created) {
+		return true;
+	}
+#ifdef __QNX__
 	// Create a message channel for communication
 	channel_id = ChannelCreate(0);
 	// Attach to the message channel
@@ -10,64 +62,130 @@ ATCTimer::ATCTimer(uint32_t sec, uint32_t msec) {
 	// Error handling if connection fails
 	if(connection_id == -1){
 		std::cerr << "Timer, Connect Attach error : " << errno << "\n";
+		return false;
 	}
-	
+
 	// Initialize the signal event for the timer
 	SIGEV_PULSE_INIT(&sig_event, connection_id, SIGEV_PULSE_PRIO_INHERIT, 1, 0);
 
-	// Create the timer with real-time clock and the signal event
-	if (timer_create(CLOCK_REALTIME, &sig_event, &timer_id) == -1){
+	// Create the timer with the monotonic clock and the signal event
+	if (timer_create(CLOCK_MONOTONIC, &sig_event, &timer_id) == -1){
 		std::cerr << "Timer, Init error : " << errno << "\n";
+		return false;
 	}
-	
-	// Set up the timer specifications (interval and initial expiration)
-	setTimerSpecification(sec,1000000* msec); //converting ms to ns
-
-	// Get the system's cycles per second for time calculations
-	cycles_per_sec = SYSPAGE_ENTRY(qtime)->cycles_per_sec;
-	
+#else
+	timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	if (timer_fd == -1) {
+		std::cerr << "Timer, Init error : " << errno << "\n";
+		return false;
+	}
+#endif
+	timer_created = true;
+	return true;
+}
 
+// Function to set the timer specifications (time intervals)
+void ATCTimer::setTimerSpecification(uint32_t sec, uint32_t nano){ // pure periodic timer
+	setPeriodNs((uint64_t)sec * 1000000000ULL + nano);
 }
 
-ATCTimer::~ATCTimer() {}
+void ATCTimer::setPeriodNs(uint64_t periodNs) {
+	period_ns = periodNs;
+	if (period_ns == 0) {
+		if (timer_created) {
+			// Disarm
+			struct itimerspec off = {};
+#ifdef __QNX__
+			timer_settime(timer_id, 0, &off, NULL);
+#else
+			timerfd_settime(timer_fd, 0, &off, NULL);
+#endif
+		}
+		return;
+	}
+	if (!createTimer()) {
+		period_ns = 0;
+		return;
+	}
+	startTimer(); //starts the timer
+}
 
 //Function to start the timer
 void ATCTimer::startTimer(){
-	timer_settime(timer_id, 0, &timer_spec, NULL);
+	if (period_ns == 0) {
+		return;
+	}
+	// First deadline one period from now, then every period after it, on absolute time
+	startTimerAt(nowNs() + period_ns);
 }
 
-// Function to set the timer specifications (time intervals)
-void ATCTimer::setTimerSpecification(uint32_t sec, uint32_t nano){ // pure periodic timer
-	// Set the initial time value for the timer
-	timer_spec.it_value.tv_sec = sec;
-	timer_spec.it_value.tv_nsec = nano;
+void ATCTimer::startTimerAt(uint64_t firstDeadlineNs){
+	if (period_ns == 0) {
+		return;
+	}
+	next_deadline_ns = firstDeadlineNs;
+	struct itimerspec timer_spec;
+	timer_spec.it_value = toTimespec(next_deadline_ns);
+	timer_spec.it_interval = toTimespec(period_ns);
+#ifdef __QNX__
+	timer_settime(timer_id, TIMER_ABSTIME, &timer_spec, NULL);
+#else
+	timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &timer_spec, NULL);
+#endif
+}
 
-	// Set the interval for periodic execution
-	timer_spec.it_interval.tv_sec = sec;
-	timer_spec.it_interval.tv_nsec = nano;
+// Function to block and wait for the timer's deadline
+uint64_t ATCTimer::waitTimer(){
+	if (period_ns == 0) {
+		return 0;  // Never armed
+	}
 
-	// Start the timer with the updated specifications
-	timer_settime(timer_id, 0, &timer_spec, NULL); //starts the timer
-}
+	uint64_t now;
+#ifdef __QNX__
+	// Receive a message (this call blocks until the timer pulses).
+	// Pulses queued while the caller was late are for deadlines already accounted for: skip them.
+	do {
+		if (MsgReceive(channel_id, &msg_buffer, sizeof(msg_buffer), NULL) == -1 && errno != EINTR) {
+			return 0;
+		}
+		now = nowNs();
+	} while (now < next_deadline_ns);
+#else
+	uint64_t expirations;
+	while (read(timer_fd, &expirations, sizeof(expirations)) == -1) {
+		if (errno != EINTR) {
+			return 0;
+		}
+	}
+	now = nowNs();
+#endif
 
-// Function to block and wait for the timer's signal
-void ATCTimer::waitTimer(){
-	// Receive a message (this call blocks until the timer pulses)
-	int receive_message_id; //to identify source
-	receive_message_id = MsgReceive(channel_id, &msg_buffer, sizeof(msg_buffer), NULL);
+	// Deadlines passed after next_deadline_ns were missed; the next one stays on the original grid
+	uint64_t missed = (now - next_deadline_ns) / period_ns;
+	next_deadline_ns += (missed + 1) * period_ns;
+	overruns += missed;
+	return missed;
 }
 
 // Function to record the current time (in cycles)
 void ATCTimer::tick(){
+#ifdef __QNX__
 	// Record the current number of cycles (for time measurement)
 	tick_cycles = ClockCycles();
+#else
+	tick_ns = nowNs();
+#endif
 }
 
 // Function to calculate the elapsed time in milliseconds since the last tick
 double ATCTimer::tock(){
+#ifdef __QNX__
 	// Record the current number of cycles (for time measurement)
 	tock_cycles = ClockCycles();
 	// Calculate and return the elapsed time in milliseconds
 	return (double)(tock_cycles - tick_cycles) / cycles_per_sec * 1000.0;
+#else
+	tock_ns = nowNs();
+	return (double)(tock_ns - tick_ns) / 1000000.0;
+#endif
 }
-
@@ -6,29 +6,32 @@
  * For example, we need to manage the updatePosition of our planes
  *
  * *****Timer Setup and Management*****:
- * The class creates and manages a periodic timer. This timer can be configured to expire
- * at a specific time and then repeat itself at the set interval.
- * It uses system calls and libraries (timer_create, SIGEV_PULSE_INIT, timer_settime)
- * to create and control the timer.
+ * The class creates and manages a periodic timer on CLOCK_MONOTONIC.
+ * Expirations are absolute deadlines: start + k * period. A late wakeup never
+ * shifts the following ones, so the timer does not drift over a long run.
+ * The period is given in seconds and milliseconds, or in nanoseconds for
+ * sub-millisecond periods (setPeriodNs).
  *
- * The constructor (cTimer::cTimer) initializes the timer, setting up a message
- * channel and attaching a signal event for handling timer interrupts or pulses.
- * The timer is then set with an initial expiration time (sec, msec) and a periodic interval.
+ * *****Backends*****:
+ * QNX: timer_create with a SIGEV_PULSE event, armed with TIMER_ABSTIME, and a
+ * message channel (ChannelCreate and MsgReceive) to receive the pulses.
+ * Linux: a timerfd armed with TFD_TIMER_ABSTIME; waitTimer reads it.
  *
- * *****Message Handling for Timer Events:*****
- * The timer pulses (interrupts) are communicated via message passing.
- * The class uses a message channel (ChannelCreate and MsgReceive) to receive signals
- * when the timer expires. The waitTimer function blocks until a timer pulse occurs,
- * indicating that the timer's set interval has elapsed. This could be useful in systems
- * where an application needs to wait for periodic events (e.g., sensor sampling, task scheduling).
+ * *****Waiting for the Timer*****:
+ * The waitTimer function blocks until the next deadline and returns the
+ * number of overruns: whole periods that passed since the previous wait
+ * without being waited for (0 when the caller keeps up). getOverruns()
+ * returns the total.
  *
  * *****Time Measurement****:
- * The class provides a mechanism to measure elapsed time by using the system's clock cycles.
- * Uses tick() and tock() to find elapsed time
+ * tick() and tock() measure elapsed time in milliseconds: with ClockCycles()
+ * (the TSC) on QNX and clock_gettime(CLOCK_MONOTONIC) on Linux.
  *
  * ***Customize timer****
  * Users can customize the timer's interval by specifying seconds and milliseconds
- * (via the setTimerSpec function)
+ * (via the setTimerSpecification function)
+ * A timer built with (0,0) is never armed: only tick() and tock() are usable
+ * (see DeadlineMonitor).
  *
  */
 
@@ -41,24 +44,24 @@
 #include <errno.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <inttypes.h>
+#include <stdint.h>
+#ifdef __QNX__
 #include <sync.h>
 #include <sys/siginfo.h>
 #include <sys/neutrino.h>
 #include <sys/netmgr.h>
 #include <sys/syspage.h>
-#include <inttypes.h>
-#include <stdint.h>
+#endif
 
 class ATCTimer {
+#ifdef __QNX__
 	int channel_id;  		// The ID of the message channel
 	int connection_id;		// The ID for the connection to the timer
 
 	// Structure for timer signal event
 	struct sigevent sig_event;
 
-	// Structure for timer specification (time intervals)
-	struct itimerspec timer_spec;
-
 	// Timer identifier
 	timer_t timer_id;
 
@@ -67,19 +70,39 @@ class ATCTimer {
 	// Clock-related variables
 	uint64_t cycles_per_sec; 			// Cycles per second, for time calculation
 	uint64_t tick_cycles, tock_cycles;	// Variables to store cycle counts for time measurement
+#else
+	int timer_fd;					// timerfd delivering the expirations
+	uint64_t tick_ns, tock_ns;		// CLOCK_MONOTONIC readings for time measurement
+#endif
+
+	uint64_t period_ns;				// 0 when the timer is not armed
+	uint64_t next_deadline_ns;		// Absolute CLOCK_MONOTONIC time of the next expiration
+	uint64_t overruns;				// Total periods missed by waitTimer callers
+	bool timer_created;				// Kernel timer exists (created on the first non-zero period)
+
+	bool createTimer();
 public:
 	// Constructor to initialize timer with seconds and milliseconds
 	ATCTimer(uint32_t,uint32_t);
 
+	// Current CLOCK_MONOTONIC time in nanoseconds
+	static uint64_t nowNs();
 
-	// Function to set the timer specifications (time intervals)
+	// Function to set the timer specifications (seconds, nanoseconds) and start it
 	void setTimerSpecification(uint32_t,uint32_t);
 
-	// Function to block until the timer expires
-	void waitTimer();
+	// Set any period in nanoseconds (sub-millisecond periods allowed) and start the timer
+	void setPeriodNs(uint64_t periodNs);
+	uint64_t getPeriodNs() const { return period_ns; }
+
+	// Block until the next deadline; returns the periods missed since the previous wait
+	uint64_t waitTimer();
+	uint64_t getOverruns() const { return overruns; }
 
-	// Function to start the timer
+	// Function to (re)start the timer: the first deadline is one period from now
 	void startTimer();
+	// Restart the timer with its first deadline at an absolute CLOCK_MONOTONIC time (phase)
+	void startTimerAt(uint64_t firstDeadlineNs);
 
 	// Function to record the current time for tick
 	void tick();
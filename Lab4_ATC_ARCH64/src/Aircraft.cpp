@@ -2,8 +2,13 @@
 #include <iomanip>
 #include <memory>
 #include <pthread.h>
+#include <cstring>
 #include "Aircraft.h"
 #include "ATCTimer.h"
+#include "DeadlineMonitor.h"
+#include "TimeBase.h"
+#include "ThreadProfile.h"
+#include "MemoryWarmup.h"
 
 
 //Coen320_Lab (Task0): Radar Channel name should contain your group name
@@ -19,7 +24,8 @@ void* updatePositionThread(void* arg) {
 Aircraft::Aircraft(int id, double x, double y, double z, double sx, double sy, double sz, int t)
     : id(id), posX(x), posY(y), posZ(z), speedX(sx), speedY(sy), speedZ(sz), arrivalTime(t), inAirspace(true) {
 	message_id = -1;
-	Radar_id = -1;
+	stateTime = 0;
+	commandSeq = 0;
 	airspace = {0, 100000, 0, 100000, 15000, 40000};
 	// Coen320_lab3(Task1): You need to create a thread worker
 	// Worker function: updatePositionThread
@@ -55,22 +61,23 @@ void Aircraft::changeHeading(double Vx, double Vy, double Vz){
 
 
 int Aircraft::updatePosition() {
+    ThreadProfiles::apply("aircraft");
+    MemoryWarmup::prefaultStack();  // Answers the Radar's polls
     ATCTimer timer(1, 0);
     int currentTime = 0;  // Variable to track current time
 
     // Wait until the arrival time has passed
     while (currentTime < arrivalTime) {
-        timer.waitTimer();  // Wait for 1 second
-        ++currentTime;
+        currentTime += 1 + timer.waitTimer();  // Wait for 1 second (counting any missed one)
     }
 
     //********SEND ENTER AIRSPACE TO RADAR**************
     // Coen320_Lab3(Task5): We are using message passing. Learn how to open a channel with Radar module
     // Open channel with radar and verify if the channel is opened successfully
-    // Use the function name_open with the radar channel name and parameter 0
+    // Open the connection with the radar channel name
     // (specified in Task0 in file Radar.cpp e.g. "your_group_name_or_id_Radar")
 
-    if ((Radar_id = name_open("chris_Radar", 0)/* open the channel here*/) == -1) {
+    if (!Radar_channel.open(Radar)) {
 		perror("Error occurred while creating the channel with Radar");
 		return EXIT_FAILURE;
 	}
@@ -80,17 +87,14 @@ int Aircraft::updatePosition() {
     Message enterAirspaceMessage = createEnterAirspaceMessage(id);
 
     // Send message
-    //Coen320_Lab3(Task7): send a message using MsgSend function to Radar_id channel
+    //Coen320_Lab3(Task7): send a message on the Radar connection
     //Parameters:
-    //Channel ID (e.g. Radar_id)
     //Message address (e.g., &createEnterAirspaceMessage)
-    // size of the message
-    //Respond Message address (put zero)
-    //Respond Message size (put zero)
-    //For more information use ctrl+space
-    //MsgSend(<Channel ID>, <msg>, <msg size>,0,0)
+    // size of the message (its size(): header plus payload)
+    //The reply buffer and size default to none
+    //Radar_channel.send(<msg>, <msg size>)
 
-    if (MsgSend(Radar_id, &enterAirspaceMessage, sizeof(enterAirspaceMessage), 0, 0)/* Put the MsgSend function here*/ == -1) {
+    if (Radar_channel.send(&enterAirspaceMessage, enterAirspaceMessage.size()) == -1) {
             std::cout << "Failed to send enter message to Radar!\n";
             return EXIT_FAILURE;
 	}
@@ -101,19 +105,24 @@ int Aircraft::updatePosition() {
     //Note: It is important to not interfere channel names with other groups
     std::string id_str = "chris"+std::to_string(id);  // Convert integer id to string
     const char* ID = id_str.c_str();         // Convert string to const char*
-    name_attach_t* plane_channel = name_attach(NULL, ID, 0); // For server
+    IpcServer plane_channel(ID); // For server
 
-    if (plane_channel == NULL) {
+    if (!plane_channel.isAttached()) {
             std::cerr << "Could not attach plane ID: " << ID << " to channel\n";
             return EXIT_FAILURE;
         }
 
+        // Track how well the 1 s update period is kept
+        DeadlineMonitor updateDeadline("Aircraft " + std::to_string(id) + " updatePosition", timer, 1000.0);
+
         // Start the position update loop
         while (true) {
+            updateDeadline.release();
             // Update position based on velocity
             posX += speedX;
             posY += speedY;
             posZ += speedZ;
+            stateTime = TimeBase::nowNs();  // Start of the sensor-to-alert latency trace
 
             // Debug: Print the new position
             std::cout << "Updated Position: (" << posX << ", " << posY << ", " << posZ << ")\n";
@@ -124,7 +133,7 @@ int Aircraft::updatePosition() {
                 posZ < airspace.lower_z_boundary || posZ > airspace.upper_z_boundary) {
                 // Send exit airspace message and exit loop if out of bounds
                 Message exitAirspaceMessage = createExitAirspaceMessage(id);
-                if (MsgSend(Radar_id, &exitAirspaceMessage, sizeof(exitAirspaceMessage), 0, 0) == -1) {
+                if (Radar_channel.send(&exitAirspaceMessage, exitAirspaceMessage.size()) == -1) {
                     std::cout << "Failed to send exit message to Radar!\n";
                     return EXIT_FAILURE;
                 }
@@ -132,73 +141,85 @@ int Aircraft::updatePosition() {
             }
 
             // Check for incoming position update requests from Radar
-            char buffer[sizeof(Message_inter_process)];  // Buffer to handle largest message size
-            int rcvid = MsgReceive(plane_channel->chid, buffer, sizeof(buffer), NULL);
-
-            if (rcvid != -1) {
-
-            	bool isInterProcess = buffer[0] & 0x01;
-                // Radar requested position data
-                if (isInterProcess){  //sporadic
-                	// Message is of type Message_inter_process
-                	Message_inter_process* receivedMsg = reinterpret_cast<Message_inter_process*>(buffer);
-
-                	// Handle different message types using switch
-                    // COEN320 Lab 4_5: You need to handle different message types here
-                    // These commands come from Communication System
-
-
-                    switch (receivedMsg->type) {
-                        case MessageType::REQUEST_CHANGE_OF_HEADING: {
-                            msg_change_heading ch;
-                            std::memcpy(&ch, receivedMsg->data.data(), sizeof(ch));
-                            speedX = ch.VelocityX;
-                            speedY = ch.VelocityY;
-                            speedZ = ch.VelocityZ;
-                            if (ch.altitude != 0) posZ = ch.altitude;
-                            std::cout << "Plane " << id << " heading updated by operator.\n";
-                            break;
-                        }
-                        case MessageType::REQUEST_CHANGE_POSITION: {
-                            msg_change_position cp;
-                            std::memcpy(&cp, receivedMsg->data.data(), sizeof(cp));
-                            posX = cp.x;
-                            posY = cp.y;
-                            posZ = cp.z;
-                            std::cout << "Plane " << id << " position updated by operator.\n";
-                            break;
-                        }
-                        case MessageType::REQUEST_CHANGE_ALTITUDE: {
-                            msg_change_heading ch;
-                            std::memcpy(&ch, receivedMsg->data.data(), sizeof(ch));
-                            posZ = ch.altitude;
-                            std::cout << "Plane " << id << " altitude updated by operator.\n";
-                            break;
-                        }
-                        default:
-                            break;
+            Message receivedMsg;
+            size_t received = 0;
+            int rcvid = plane_channel.receive(&receivedMsg, sizeof(receivedMsg), received);
+
+            if (rcvid != -1 && !receivedMsg.valid(received)) {
+                plane_channel.error(rcvid, EPROTO);
+            } else if (rcvid != -1) {
+                // Handle different message types using switch
+                // COEN320 Lab 4_5: You need to handle different message types here
+                // REQUEST_POSITION is the periodic poll from Radar; the
+                // change requests are sporadic and come from Communication System
+                bool isCommand = true;
+                bool applied = false;  // A malformed payload or an unknown type changes nothing
+                switch (receivedMsg.header.type) {
+                    case MessageType::REQUEST_POSITION: {
+                        // Radar requested position data
+                        msg_plane_info positionData = {id, posX, posY, posZ, speedX, speedY, speedZ, stateTime, 0, commandSeq};
+                        Message posUpdateMessage = createPositionUpdateMessage(id, positionData);
+
+                        plane_channel.reply(rcvid, 0, &posUpdateMessage, posUpdateMessage.size()); // Send reply with position
+                        isCommand = false;
+                        break;
                     }
+                    case MessageType::REQUEST_CHANGE_OF_HEADING: {
+                        const msg_change_heading* ch = receivedMsg.get<msg_change_heading>();
+                        if (!ch) break;
+                        speedX = ch->VelocityX;
+                        speedY = ch->VelocityY;
+                        speedZ = ch->VelocityZ;
+                        if (ch->altitude != 0) posZ = ch->altitude;
+                        applied = true;
+                        std::cout << "Plane " << id << " heading updated by operator.\n";
+                        break;
+                    }
+                    case MessageType::REQUEST_CHANGE_POSITION: {
+                        const msg_change_position* cp = receivedMsg.get<msg_change_position>();
+                        if (!cp) break;
+                        posX = cp->x;
+                        posY = cp->y;
+                        posZ = cp->z;
+                        applied = true;
+                        std::cout << "Plane " << id << " position updated by operator.\n";
+                        break;
+                    }
+                    case MessageType::REQUEST_CHANGE_ALTITUDE: {
+                        const msg_change_heading* ch = receivedMsg.get<msg_change_heading>();
+                        if (!ch) break;
+                        posZ = ch->altitude;
+                        applied = true;
+                        std::cout << "Plane " << id << " altitude updated by operator.\n";
+                        break;
+                    }
+                    default:
+                        break;
+                }
 
-                    // Reply to sender if needed
-                    MsgReply(rcvid, EOK, nullptr, 0);
-                } else {  //periodic
-                	// Message is of type Message
-                	Message* receivedMsg = reinterpret_cast<Message*>(buffer);
-
-                	if (receivedMsg->type == MessageType::REQUEST_POSITION) {
-                		msg_plane_info positionData = {id, posX, posY, posZ, speedX, speedY, speedZ};
-                	    Message posUpdateMessage = createPositionUpdateMessage(id, positionData);
+                if (isCommand && applied) {
+                    // Echoed in the next position reply so ComputerSystem can see the command take effect
+                    if (receivedMsg.header.sequence > commandSeq) {
+                        commandSeq = receivedMsg.header.sequence;
+                    }
 
-                	    MsgReply(rcvid, 0, &posUpdateMessage, sizeof(posUpdateMessage)); // Send reply with position
-                	}
+                    // Reply to sender if needed
+                    plane_channel.reply(rcvid, EOK);
+                } else if (isCommand) {
+                    // Not applied: the sender must not count it as delivered, and its sequence is not echoed
+                    plane_channel.error(rcvid, EPROTO);
                 }
             }
 
+            updateDeadline.complete();
+
             // Wait for the next time step
             timer.waitTimer();
         }
 
-        name_detach(plane_channel, 0);
+        updateDeadline.printStats();
+
+        plane_channel.detach();
         pthread_exit(NULL);
 
         return 0;
@@ -216,9 +237,7 @@ int Aircraft::updatePosition() {
 //Coen320_Lab3 (Task2): look at the message creation example here
 Message Aircraft::createEnterAirspaceMessage(int planeID){
 	Message msg;
-	msg.type = MessageType::ENTER_AIRSPACE;
-	msg.planeID = planeID;
-	msg.data = 	NULL;  // Allocate dynamically and copy info data
+	msg.init(MessageType::ENTER_AIRSPACE, planeID);  // No payload
 	return msg;
 }
 
@@ -226,9 +245,7 @@ Message Aircraft::createEnterAirspaceMessage(int planeID){
 Message Aircraft::createExitAirspaceMessage(int planeID){
 
 	Message msg;
-	msg.type = MessageType::EXIT_AIRSPACE;// Use the correct Message type
-	msg.planeID = planeID;// Use the passed Plane ID
-	msg.data = NULL;
+	msg.init(MessageType::EXIT_AIRSPACE, planeID);// Use the correct Message type and the passed Plane ID
 
 	return msg;
 }
@@ -236,9 +253,8 @@ Message Aircraft::createExitAirspaceMessage(int planeID){
 Message Aircraft::createPositionUpdateMessage(int planeID, const msg_plane_info& info) {
 
     Message msg;
-    msg.type = MessageType::POSITION_UPDATE; // Use the correct Message type
-    msg.planeID = planeID;// Use the passed Plane ID
-    msg.data = (void*)&info;  // Allocate and copy info data
+    msg.init(MessageType::POSITION_UPDATE, planeID); // Use the correct Message type and the passed Plane ID
+    *msg.put<msg_plane_info>() = info;  // The info travels inside the message
 
     return msg;
 
@@ -2,9 +2,9 @@
 #define AIRCRAFT_H_
 
 #include <iostream>
-#include <sys/dispatch.h>
 #include <thread>
 #include "Msg_structs.h"
+#include "Ipc.h"
 
 
 typedef struct {
@@ -47,9 +47,11 @@ private:
     double posX, posY, posZ;    // Position
     double speedX, speedY, speedZ; // Speed
     int arrivalTime;            // Time of Arrival
+    uint64_t stateTime;         // When the current position was computed (monotonic ns)
+    uint32_t commandSeq;        // Sequence number of the last operator command applied
     int message_id;				//to identify who sends the service
     bool inAirspace;
-    int Radar_id;
+    IpcConnection Radar_channel;  // Connection to the Radar for enter/exit messages
     airspace_struct airspace;
     //Message creation
     Message createEnterAirspaceMessage(int planeID);
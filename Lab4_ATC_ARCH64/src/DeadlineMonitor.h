@@ -0,0 +1,70 @@
+/*
+ * The DeadlineMonitor class watches one periodic loop and records how well it
+ * keeps up with its period, using the tick()/tock() of an ATCTimer.
+ *
+ * Usage inside the loop:
+ *     timer.waitTimer();      // or any other wakeup
+ *     monitor.release();      // start of the iteration
+ *     ...work...
+ *     monitor.complete();     // end of the iteration
+ *
+ * *****Measurements*****:
+ * - execution time of each iteration (min/avg/max, max is the observed WCET)
+ * - release jitter: how far each release interval is from the period
+ * - deadline misses: iterations whose execution time exceeded the deadline
+ * - skipped periods: whole periods that passed without a release
+ * - page faults taken between release() and complete(), the first
+ *   WARMUP_ITERATIONS iterations apart from the steady-state ones (MemoryWarmup)
+ *
+ * getStats() returns a snapshot that can be read from any thread.
+ * An ATCTimer built with (0,0) is never armed and can be used for measurement only.
+ */
+
+#ifndef DEADLINEMONITOR_H_
+#define DEADLINEMONITOR_H_
+
+#include <mutex>
+#include <string>
+#include <cstdint>
+#include "ATCTimer.h"
+
+struct DeadlineStats {
+	std::string name;
+	double periodMs = 0.0;
+	double deadlineMs = 0.0;
+	uint64_t iterations = 0;
+	uint64_t deadlineMisses = 0;
+	uint64_t skippedPeriods = 0;
+	double minExecMs = 0.0;
+	double avgExecMs = 0.0;
+	double maxExecMs = 0.0;    // Observed worst-case execution time
+	double avgJitterMs = 0.0;
+	double maxJitterMs = 0.0;
+	long warmupPageFaults = 0;
+	long steadyPageFaults = 0;  // Should stay 0 once the loop is warm
+};
+
+class DeadlineMonitor {
+public:
+	// deadlineMs of 0 means the deadline equals the period
+	DeadlineMonitor(const std::string& name, ATCTimer& timer, double periodMs, double deadlineMs = 0.0);
+
+	void release();   // Call when the iteration is released (after the wakeup)
+	void complete();  // Call when the iteration's work is done
+
+	DeadlineStats getStats();
+	void printStats();
+
+private:
+	ATCTimer& timer;
+	bool released = false;     // At least one release happened
+	double totalExecMs = 0.0;
+	double totalJitterMs = 0.0;
+	uint64_t jitterSamples = 0;
+	long faultsAtRelease = -1;
+
+	DeadlineStats stats;
+	std::mutex statsMutex;
+};
+
+#endif /* DEADLINEMONITOR_H_ */
@@ -0,0 +1,366 @@
+#include "FlightArchive.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
+#include "TimeBase.h"
+#include "ThreadProfile.h"
+#include "MemoryWarmup.h"
+
+namespace {
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+	while (value >= 0x80) {
+		out.push_back(static_cast<uint8_t>(value) | 0x80);
+		value >>= 7;
+	}
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+bool getVarint(const uint8_t*& in, const uint8_t* end, uint64_t& value) {
+	value = 0;
+	for (int shift = 0; in < end && shift < 64; shift += 7) {
+		uint8_t byte = *in++;
+		value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) {
+			return true;
+		}
+	}
+	return false;  // Truncated column
+}
+
+// Small deltas of either sign become small unsigned values
+uint64_t zigzag(int64_t value) {
+	return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+	return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+int64_t millimetres(double metres) {
+	return std::llround(metres * 1000.0);
+}
+
+// Value of one column for a row; the inverse is applied in FlightArchive::query()
+int64_t columnValue(int column, int64_t time, const msg_plane_info& p) {
+	switch (column) {
+	case 0: return time;
+	case 1: return p.id;
+	case 2: return millimetres(p.PositionX);
+	case 3: return millimetres(p.PositionY);
+	case 4: return millimetres(p.PositionZ);
+	case 5: return millimetres(p.VelocityX);
+	case 6: return millimetres(p.VelocityY);
+	case 7: return millimetres(p.VelocityZ);
+	case 8: return static_cast<int64_t>(p.pollTime - p.stateTime);
+	default: return p.commandSeq;
+	}
+}
+
+bool writeAll(int fd, const void* data, size_t size) {
+	const char* bytes = static_cast<const char*>(data);
+	while (size > 0) {
+		ssize_t written = write(fd, bytes, size);
+		if (written == -1) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+		bytes += written;
+		size -= written;
+	}
+	return true;
+}
+
+} // namespace
+
+FlightArchive::FlightArchive(const std::string& path)
+	: path(path), fd(-1), indexFd(-1), epochNs(TimeBase::epochNs()), fileSize(0), indexSize(0), slots(ARCHIVE_QUEUE_FRAMES) {
+	// Every frame the publish path can hand over fits in its slot without allocating
+	for (std::vector<msg_plane_info>& slot : slots) {
+		MemoryWarmup::prefault(slot, SHARED_MEMORY_MAX_PLANES);
+	}
+	chunk.reserve(ARCHIVE_CHUNK_ROWS + SHARED_MEMORY_MAX_PLANES);
+
+	fd = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0666);
+	indexFd = open((path + ".idx").c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0666);
+	ArchiveHeader header = {};
+	std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+	header.columns = ARCHIVE_COLUMNS;
+	header.epochNs = epochNs;
+	if (fd == -1 || indexFd == -1 || !writeAll(fd, &header, sizeof(header))) {
+		std::cerr << "FlightArchive: cannot create " << path << ": " << strerror(errno) << ", frames are not archived\n";
+		if (fd != -1) close(fd);
+		if (indexFd != -1) close(indexFd);
+		fd = indexFd = -1;
+		return;
+	}
+	fileSize = sizeof(header);
+
+	writer = std::thread(&FlightArchive::writerLoop, this);
+}
+
+FlightArchive::~FlightArchive() {
+	stopThread.store(true);
+	if (writer.joinable()) {
+		writer.join();  // Drains the ring and writes the last chunk
+	}
+	if (fd != -1) close(fd);
+	if (indexFd != -1) close(indexFd);
+	printStats(std::cout);
+}
+
+void FlightArchive::append(const std::vector<msg_plane_info>& planes) {
+	if (fd == -1) {
+		return;
+	}
+	frames++;
+	uint64_t h = head.load(std::memory_order_relaxed);
+	if (h - tail.load(std::memory_order_acquire) >= slots.size()) {
+		dropped++;  // Writer too far behind: never wait for it
+		return;
+	}
+	slots[h % slots.size()].assign(planes.begin(), planes.end());
+	head.store(h + 1, std::memory_order_release);
+}
+
+void FlightArchive::writerLoop() {
+	ThreadProfiles::apply("archive.write");
+	MemoryWarmup::prefaultStack();
+	while (!stopThread.load()) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(ARCHIVE_POLL_MS));
+		drain();
+		// A chunk is not held in memory forever when traffic is light
+		if (!chunk.empty() && TimeBase::nowNs() - chunkStartNs >= ARCHIVE_CHUNK_MS * 1000000ULL) {
+			writeChunk();
+		}
+	}
+	drain();
+	if (!chunk.empty()) {
+		writeChunk();
+	}
+}
+
+void FlightArchive::drain() {
+	uint64_t t = tail.load(std::memory_order_relaxed);
+	while (t != head.load(std::memory_order_acquire)) {
+		if (chunk.empty()) {
+			chunkStartNs = TimeBase::nowNs();
+		}
+		for (const msg_plane_info& plane : slots[t % slots.size()]) {
+			uint64_t& last = lastState[plane.id];
+			if (plane.stateTime == last) {
+				continue;  // Same state as in an earlier frame
+			}
+			last = plane.stateTime;
+			chunk.push_back(Row{static_cast<int64_t>(plane.stateTime - epochNs), plane});
+		}
+		tail.store(++t, std::memory_order_release);  // Slot free for append()
+		if (chunk.size() >= ARCHIVE_CHUNK_ROWS) {
+			writeChunk();
+		}
+	}
+}
+
+void FlightArchive::writeChunk() {
+	if (!writable) {
+		chunk.clear();
+		return;
+	}
+	// Rows of one plane together, in time order (frames arrive in time order)
+	std::stable_sort(chunk.begin(), chunk.end(), [](const Row& a, const Row& b) { return a.info.id < b.info.id; });
+
+	ArchiveChunkHeader header = {};
+	header.magic = ARCHIVE_CHUNK_MAGIC;
+	header.rows = static_cast<uint32_t>(chunk.size());
+	header.columns = ARCHIVE_COLUMNS;
+	header.minTime = INT64_MAX;
+	header.maxTime = INT64_MIN;
+	std::vector<ArchivePlaneEntry> planes;
+	for (size_t i = 0; i < chunk.size(); ++i) {
+		const Row& row = chunk[i];
+		if (planes.empty() || planes.back().id != row.info.id) {
+			planes.push_back(ArchivePlaneEntry{row.info.id, static_cast<uint32_t>(i), 0, 0, row.time, row.time});
+		}
+		ArchivePlaneEntry& plane = planes.back();
+		plane.rows++;
+		plane.minTime = std::min(plane.minTime, row.time);
+		plane.maxTime = std::max(plane.maxTime, row.time);
+		header.minTime = std::min(header.minTime, row.time);
+		header.maxTime = std::max(header.maxTime, row.time);
+	}
+	header.planes = static_cast<uint32_t>(planes.size());
+
+	// Header, plane entries and column sizes first, filled in once the columns are encoded
+	size_t columnSizesAt = sizeof(header) + planes.size() * sizeof(ArchivePlaneEntry);
+	encoded.assign(columnSizesAt + ARCHIVE_COLUMNS * sizeof(uint32_t), 0);
+	uint32_t columnSizes[ARCHIVE_COLUMNS];
+	for (int column = 0; column < ARCHIVE_COLUMNS; ++column) {
+		size_t start = encoded.size();
+		int64_t previous = 0;
+		for (const Row& row : chunk) {
+			int64_t value = columnValue(column, row.time, row.info);
+			putVarint(encoded, zigzag(value - previous));
+			previous = value;
+		}
+		columnSizes[column] = static_cast<uint32_t>(encoded.size() - start);
+	}
+	std::memcpy(encoded.data(), &header, sizeof(header));
+	std::memcpy(encoded.data() + sizeof(header), planes.data(), planes.size() * sizeof(ArchivePlaneEntry));
+	std::memcpy(encoded.data() + columnSizesAt, columnSizes, sizeof(columnSizes));
+
+	ArchiveChunkIndex index = {fileSize, static_cast<uint32_t>(encoded.size()), header.rows,
+	                           header.minTime, header.maxTime, planes.front().id, planes.back().id};
+	// The index entry only once the chunk is on disk: a reader never follows it to a partial chunk
+	bool written = writeAll(fd, encoded.data(), encoded.size()) && writeAll(indexFd, &index, sizeof(index));
+
+	std::lock_guard<std::mutex> lock(statsMutex);
+	if (written) {
+		fileSize += encoded.size();
+		indexSize += sizeof(index);
+		stats.rows += chunk.size();
+		stats.chunks++;
+	} else {
+		if (stats.writeErrors++ == 0) {
+			std::cerr << "FlightArchive: write to " << path << " failed: " << strerror(errno) << "\n";
+		}
+		// Drop whatever part of the chunk or of its entry got written: the next chunk
+		// starts where the index says the file ends
+		if (ftruncate(fd, fileSize) == -1 || lseek(fd, fileSize, SEEK_SET) == -1
+		    || ftruncate(indexFd, indexSize) == -1 || lseek(indexFd, indexSize, SEEK_SET) == -1) {
+			std::cerr << "FlightArchive: cannot roll back " << path << ": " << strerror(errno) << ", frames are no longer archived\n";
+			writable = false;
+		}
+	}
+	stats.bytes = fileSize;
+	chunk.clear();
+}
+
+bool FlightArchive::query(const std::string& path, int planeID, double t1, double t2, std::vector<ArchiveRow>& out) {
+	out.clear();
+	std::ifstream file(path, std::ios::binary);
+	std::ifstream indexFile(path + ".idx", std::ios::binary);
+	ArchiveHeader header;
+	if (!file || !indexFile || !file.read(reinterpret_cast<char*>(&header), sizeof(header))
+	    || std::memcmp(header.magic, ARCHIVE_MAGIC, sizeof(header.magic)) != 0 || header.columns != ARCHIVE_COLUMNS) {
+		std::cerr << "FlightArchive: " << path << " is not a flight archive\n";
+		return false;
+	}
+	file.seekg(0, std::ios::end);
+	uint64_t size = file.tellg();
+	int64_t from = std::llround(t1 * 1e9);
+	int64_t to = std::llround(t2 * 1e9);
+
+	ArchiveChunkIndex index;
+	std::vector<ArchivePlaneEntry> planes;
+	std::vector<uint8_t> columns;
+	std::vector<ArchiveRow> rows;
+	while (indexFile.read(reinterpret_cast<char*>(&index), sizeof(index))) {
+		// Time index, then ID range: most chunks are skipped without being read
+		if (index.maxTime < from || index.minTime > to || planeID < index.minId || planeID > index.maxId
+		    || index.offset + index.bytes > size) {
+			continue;
+		}
+		ArchiveChunkHeader chunk;
+		file.seekg(index.offset);
+		if (!file.read(reinterpret_cast<char*>(&chunk), sizeof(chunk)) || chunk.magic != ARCHIVE_CHUNK_MAGIC) {
+			std::cerr << "FlightArchive: bad chunk at offset " << index.offset << " of " << path << "\n";
+			continue;
+		}
+		uint32_t columnSizes[ARCHIVE_COLUMNS];
+		uint64_t headerBytes = sizeof(chunk) + static_cast<uint64_t>(chunk.planes) * sizeof(ArchivePlaneEntry) + sizeof(columnSizes);
+		if (headerBytes > index.bytes) {
+			std::cerr << "FlightArchive: bad chunk at offset " << index.offset << " of " << path << "\n";
+			continue;
+		}
+		planes.resize(chunk.planes);
+		file.read(reinterpret_cast<char*>(planes.data()), planes.size() * sizeof(ArchivePlaneEntry));
+		// Plane-ID index of the chunk
+		auto plane = std::lower_bound(planes.begin(), planes.end(), planeID,
+		                              [](const ArchivePlaneEntry& entry, int id) { return entry.id < id; });
+		if (plane == planes.end() || plane->id != planeID || plane->maxTime < from || plane->minTime > to) {
+			continue;
+		}
+
+		file.read(reinterpret_cast<char*>(columnSizes), sizeof(columnSizes));
+		columns.resize(index.bytes - headerBytes);
+		uint64_t columnBytes = 0;
+		for (uint32_t columnSize : columnSizes) {
+			columnBytes += columnSize;
+		}
+		if (!file.read(reinterpret_cast<char*>(columns.data()), columns.size()) || columnBytes > columns.size()) {
+			std::cerr << "FlightArchive: truncated chunk at offset " << index.offset << " of " << path << "\n";
+			continue;
+		}
+
+		// Each column is decoded only as far as the last row of the plane
+		uint32_t end = plane->firstRow + plane->rows;
+		rows.assign(plane->rows, ArchiveRow{});
+		const uint8_t* column = columns.data();
+		bool valid = true;
+		for (int c = 0; c < ARCHIVE_COLUMNS && valid; ++c) {
+			const uint8_t* in = column;
+			const uint8_t* columnEnd = column + columnSizes[c];
+			int64_t value = 0;
+			for (uint32_t r = 0; r < end && valid; ++r) {
+				uint64_t delta;
+				valid = getVarint(in, columnEnd, delta);
+				value += unzigzag(delta);
+				if (r < plane->firstRow) {
+					continue;
+				}
+				ArchiveRow& row = rows[r - plane->firstRow];
+				switch (c) {
+				case 0: row.time = value; break;
+				case 1: row.info.id = static_cast<int>(value); break;
+				case 2: row.info.PositionX = value / 1000.0; break;
+				case 3: row.info.PositionY = value / 1000.0; break;
+				case 4: row.info.PositionZ = value / 1000.0; break;
+				case 5: row.info.VelocityX = value / 1000.0; break;
+				case 6: row.info.VelocityY = value / 1000.0; break;
+				case 7: row.info.VelocityZ = value / 1000.0; break;
+				case 8: row.pollDelay = value; break;
+				default: row.info.commandSeq = static_cast<uint32_t>(value); break;
+				}
+			}
+			column = columnEnd;
+		}
+		if (!valid) {
+			std::cerr << "FlightArchive: truncated chunk at offset " << index.offset << " of " << path << "\n";
+			continue;
+		}
+		for (ArchiveRow& row : rows) {
+			if (row.time < from || row.time > to) {
+				continue;
+			}
+			row.info.stateTime = header.epochNs + row.time;
+			row.info.pollTime = row.info.stateTime + row.pollDelay;
+			out.push_back(row);
+		}
+	}
+	return true;
+}
+
+ArchiveStats FlightArchive::getStats() {
+	std::lock_guard<std::mutex> lock(statsMutex);
+	ArchiveStats result = stats;
+	result.frames = frames.load();
+	result.dropped = dropped.load();
+	return result;
+}
+
+void FlightArchive::printStats(std::ostream& os) {
+	ArchiveStats s = getStats();
+	double raw = static_cast<double>(s.rows * sizeof(msg_plane_info));
+	os << "\n================= Flight Archive =================\n"
+	   << path << ": " << s.frames << " frames (" << s.dropped << " dropped), " << s.rows << " rows in "
+	   << s.chunks << " chunks, " << s.bytes / 1024 << " kB";
+	if (s.bytes > 0) {
+		os << " (" << raw / s.bytes << "x smaller than the raw frames)";
+	}
+	os << ", " << s.writeErrors << " write errors\n";
+}
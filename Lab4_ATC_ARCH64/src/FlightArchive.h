@@ -0,0 +1,169 @@
+/*
+ * The FlightArchive class records every fused frame to disk for offline
+ * analysis, and answers "all positions of plane X between t1 and t2" from
+ * that file without reading the whole of it.
+ *
+ * *****Recording*****:
+ * append() is called by TrackFusion right after each publication. It copies
+ * the frame into a free slot of a ring of ARCHIVE_QUEUE_FRAMES pre-allocated
+ * frames (single producer, single consumer, no lock) and returns; when the ring
+ * is full the frame is dropped and counted, so the publish path never waits
+ * for the disk. A background thread ("archive.write" in threads.conf) drains
+ * the ring into the current chunk and writes the chunk once it holds
+ * ARCHIVE_CHUNK_ROWS rows or is ARCHIVE_CHUNK_MS old. A track republished
+ * unchanged (same stateTime, e.g. fused again with another radar's frame) is
+ * archived once.
+ *
+ * *****File layout (columnar, chunked)*****:
+ *   <path>        ArchiveHeader, then one chunk after the other:
+ *                 ArchiveChunkHeader, one ArchivePlaneEntry per plane of the
+ *                 chunk (ascending ID), the byte size of each column, then
+ *                 the ARCHIVE_COLUMNS columns one after the other
+ *   <path>.idx    one ArchiveChunkIndex per chunk, appended once the chunk
+ *                 is written (the time index)
+ * The rows of a chunk are ordered by plane ID then time, so the rows of one
+ * plane are contiguous and its ArchivePlaneEntry (the plane-ID index) gives
+ * their range and time span.
+ *
+ * *****Compression*****:
+ * Each column is delta-encoded against the previous row, zigzagged and
+ * written as a variable-length integer: IDs and times of consecutive rows of
+ * a plane cost a byte or two. Positions and velocities are stored in
+ * millimetres (mm/s), times in ns since the time base epoch.
+ *
+ * *****Queries*****:
+ * query() reads the time index, keeps the chunks overlapping [t1, t2] whose
+ * ID range holds the plane, reads their plane entries, and decodes only the
+ * chunks that actually hold the plane within the interval.
+ */
+
+#ifndef FLIGHTARCHIVE_H_
+#define FLIGHTARCHIVE_H_
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include "Msg_structs.h"
+
+#define ARCHIVE_FILE "flights.arc"
+#define ARCHIVE_QUEUE_FRAMES 64    // Frames the writer can fall behind before frames are dropped
+#define ARCHIVE_CHUNK_ROWS 4096    // Rows per chunk
+#define ARCHIVE_CHUNK_MS 10000     // A chunk is written at the latest this long after its first row
+#define ARCHIVE_POLL_MS 100        // Writer thread wake-up period
+#define ARCHIVE_COLUMNS 10         // time, id, x, y, z, vx, vy, vz, poll delay, command sequence
+
+#define ARCHIVE_MAGIC "ATCARCH1"
+#define ARCHIVE_CHUNK_MAGIC 0x4b4e4843u  // "CHNK"
+
+struct ArchiveHeader {
+	char magic[8];        // ARCHIVE_MAGIC
+	uint32_t columns;     // ARCHIVE_COLUMNS
+	uint32_t reserved;
+	uint64_t epochNs;     // TimeBase::epochNs() of the recording: row times are relative to it
+};
+
+struct ArchiveChunkHeader {
+	uint32_t magic;       // ARCHIVE_CHUNK_MAGIC
+	uint32_t rows;
+	uint32_t planes;      // ArchivePlaneEntry records that follow
+	uint32_t columns;
+	int64_t minTime, maxTime;  // ns since epoch
+};
+
+struct ArchivePlaneEntry {
+	int32_t id;
+	uint32_t firstRow;
+	uint32_t rows;
+	uint32_t reserved;
+	int64_t minTime, maxTime;
+};
+
+struct ArchiveChunkIndex {
+	uint64_t offset;      // ArchiveChunkHeader in the archive file
+	uint32_t bytes;       // Whole chunk, header included
+	uint32_t rows;
+	int64_t minTime, maxTime;
+	int32_t minId, maxId;
+};
+
+// One archived position; times are ns since the epoch of the recording
+struct ArchiveRow {
+	int64_t time;         // stateTime
+	int64_t pollDelay;    // pollTime - stateTime
+	msg_plane_info info;  // stateTime and pollTime left as recorded (monotonic ns)
+};
+
+struct ArchiveStats {
+	uint64_t frames = 0;      // Frames handed to append()
+	uint64_t dropped = 0;     // ... dropped because the ring was full
+	uint64_t rows = 0;        // Rows written to disk
+	uint64_t chunks = 0;
+	uint64_t bytes = 0;       // Archive file size
+	uint64_t writeErrors = 0;
+};
+
+class FlightArchive {
+public:
+	// Creates (truncates) path and path.idx and starts the writer thread
+	FlightArchive(const std::string& path);
+	// Writes the last chunk
+	~FlightArchive();
+
+	FlightArchive(const FlightArchive&) = delete;
+	FlightArchive& operator=(const FlightArchive&) = delete;
+
+	bool isOpen() const { return fd != -1; }
+
+	// Publish path: never blocks, drops the frame if the writer is ARCHIVE_QUEUE_FRAMES behind
+	void append(const std::vector<msg_plane_info>& planes);
+
+	ArchiveStats getStats();
+	void printStats(std::ostream& os);
+
+	// Positions of planeID with t1 <= time <= t2 (seconds since the epoch), in time order
+	static bool query(const std::string& path, int planeID, double t1, double t2, std::vector<ArchiveRow>& out);
+
+private:
+	struct Row {
+		int64_t time;
+		msg_plane_info info;
+	};
+
+	void writerLoop();
+	void drain();
+	void writeChunk();
+
+	std::string path;
+	int fd;
+	int indexFd;
+	uint64_t epochNs;
+	uint64_t fileSize;   // End of the last complete chunk
+	uint64_t indexSize;  // End of the last complete index entry
+
+	// Ring: slots[head % N] is filled by append(), slots[tail % N] emptied by the writer
+	std::vector<std::vector<msg_plane_info>> slots;
+	std::atomic<uint64_t> head{0};
+	std::atomic<uint64_t> tail{0};
+
+	// Writer thread only
+	std::vector<Row> chunk;
+	uint64_t chunkStartNs = 0;
+	std::unordered_map<int, uint64_t> lastState;  // stateTime of the last row archived per plane
+	std::vector<uint8_t> encoded;
+	bool writable = true;  // False once a failed write could not be rolled back
+
+	std::thread writer;
+	std::atomic<bool> stopThread{false};
+
+	std::atomic<uint64_t> frames{0};
+	std::atomic<uint64_t> dropped{0};
+	std::mutex statsMutex;
+	ArchiveStats stats;
+};
+
+#endif /* FLIGHTARCHIVE_H_ */
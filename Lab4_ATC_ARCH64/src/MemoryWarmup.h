@@ -0,0 +1,91 @@
+/*
+ * The MemoryWarmup class keeps the periodic loops of a process free of page
+ * faults once they reach steady state.
+ *
+ * *****Warm phase*****:
+ * At startup, before the periodic threads run:
+ *   lockProcessMemory()  mlockall() so that no page of the process is paged out,
+ *                        then grows the heap by HEAP_PREFAULT_SIZE once; malloc
+ *                        keeps freed memory instead of returning it
+ *   mapShared()          maps a shared segment, with huge pages where the OS
+ *                        supports them, then locks and touches every page
+ *   prefault(vector, n)  gives a vector the storage for n elements, touched once
+ *   prefaultStack()      first thing in each thread: touches the stack it will use
+ *
+ * On Linux everything mapped at that point (code, libraries, data) is made
+ * resident, while later mappings are locked with MCL_ONFAULT where available:
+ * their pages are locked as they are first touched, so the (mostly unused)
+ * default thread stacks are not made resident in full. glibc is limited to
+ * one malloc arena so that every thread allocates from the pre-faulted heap.
+ *
+ * *****Huge pages*****:
+ *   Linux   madvise(MADV_HUGEPAGE) on segments of at least HUGE_PAGE_SIZE
+ *           (needs shmem_enabled=advise or always for shared memory)
+ *   QNX     the segment is created physically contiguous with shm_ctl()
+ *           (SHMCTL_PHYS), which lets procnto map it with large pages
+ *
+ * *****Steady state*****:
+ * pageFaults() counts the faults of the calling thread (of the process on QNX,
+ * which has no per-thread count). DeadlineMonitor reads it around each
+ * iteration and reports the faults of the first WARMUP_ITERATIONS iterations
+ * apart from the steady-state ones, which should be 0.
+ */
+
+#ifndef MEMORYWARMUP_H_
+#define MEMORYWARMUP_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#define PREFAULT_STACK_SIZE (64 * 1024)     // Stack touched by prefaultStack()
+#define HEAP_PREFAULT_SIZE (4 * 1024 * 1024) // Heap grown and touched by lockProcessMemory()
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)    // Smallest segment worth a huge page
+#define WARMUP_ITERATIONS 3                 // Iterations of a loop counted as warm-up
+
+struct MemoryReport {
+	bool locked = false;           // lockProcessMemory() succeeded
+	std::string lockFailure;
+	size_t prefaultedBytes = 0;    // Segments, vectors and stacks touched during warm-up
+	int segments = 0;              // Shared segments mapped with mapShared()
+	int hugePageSegments = 0;      // ... of which backed by huge (large) pages
+	long minorFaults = -1;         // Whole process since start, -1 if not available
+	long majorFaults = -1;
+};
+
+class MemoryWarmup {
+public:
+	// Lock current and future memory of the process; false if not permitted
+	static bool lockProcessMemory();
+
+	// Set the size of a new shared memory object (physically contiguous on QNX)
+	static bool sizeShared(int fd, size_t size);
+	// mmap a shared memory object, with huge pages where supported, locked and pre-faulted
+	static void* mapShared(int fd, size_t size, int prot);
+
+	// Lock and touch every page of [addr, addr + size)
+	static void prefault(void* addr, size_t size);
+
+	// Room for `capacity` elements in `v`, touched once; v is left empty
+	template <typename T>
+	static void prefault(std::vector<T>& v, size_t capacity) {
+		v.resize(capacity);
+		v.clear();  // Keeps the capacity
+		countPrefaulted(capacity * sizeof(T));
+	}
+
+	// Calling thread: touch `bytes` of its stack below the caller
+	static void prefaultStack(size_t bytes = PREFAULT_STACK_SIZE);
+
+	// Page faults (minor + major) of the calling thread so far; -1 if not available
+	static long pageFaults();
+
+	static MemoryReport getReport();
+	static void printReport(std::ostream& os);
+
+private:
+	static void countPrefaulted(size_t bytes);
+};
+
+#endif /* MEMORYWARMUP_H_ */
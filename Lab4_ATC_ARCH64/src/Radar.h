@@ -1,9 +1,38 @@
+/*
+ * The Radar class polls the aircraft inside its coverage volume once per
+ * period and hands each complete poll (a RadarFrame) to the TrackFusion stage.
+ *
+ * *****Coverage and phase*****:
+ * Several radars run side by side (RADAR_CONFIG_FILE), each with its own
+ * coverage volume and update phase: the polls of a radar are released at
+ * epoch + phase + k * period on the shared time base, so radars with different
+ * phases spread their polls over the period. A radar only reports aircraft
+ * whose measured position is inside its volume.
+ *
+ * *****Share of the traffic*****:
+ * Every aircraft is polled by exactly one radar, its owner: an aircraft only
+ * answers one request per period, so a second poller would wait for its next
+ * one. TrackFusion hands each radar the aircraft it owns through a
+ * RadarAssignment (see TrackFusion.h for how owners are chosen). The aircraft
+ * a radar polled without getting a position inside its volume are listed in
+ * its frame (RadarFrame::missed), so fusion can pass them on to another radar.
+ *
+ * *****Connections*****:
+ * The connection to an aircraft is opened on its first poll and kept while
+ * the radar owns it; a connection the aircraft closed is reopened once.
+ *
+ * *****Configuration file*****:
+ *     # name  minX   maxX    minY  maxY    minZ  maxZ   phase_ms
+ *     west    0      55000   0     100000  0     50000  0
+ * Without a file a single radar covers everything with phase 0.
+ */
+
 #ifndef RADAR_H
 #define RADAR_H
 
 #include <atomic>  // Include to use atomic flag
 #include <iostream>
-#include <unordered_set>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -17,56 +46,102 @@
 #include "Aircraft.h"
 #include "Msg_structs.h"
 #include "ATCTimer.h"
+#include "DeadlineMonitor.h"
+#include "Ipc.h"
+#include "TrackSet.h"
+#include "TripleBuffer.h"
+#include "TimeBase.h"
+#include "ThreadProfile.h"
+#include "MemoryWarmup.h"
+
+#define RADAR_CONFIG_FILE "radars.conf"
+#define RADAR_PERIOD_MS 1000
+#define RADAR_HANDOFF_MARGIN 1000.0  // m; more than an aircraft covers in one period
+
+class TrackFusion;
+
+struct RadarConfig {
+    std::string name;
+    double minX, maxX, minY, maxY, minZ, maxZ;  // Coverage volume (m), bounds included
+    int phaseMs;                                // Offset of the polls within the period
+};
+
+// One complete poll of the airspace
+struct RadarFrame {
+    std::vector<msg_plane_info> planes;
+    std::vector<int> missed;  // Polled, but no answer or answered outside the coverage
+    uint64_t tick = 0;        // Simulation tick (TimeBase) when the poll completed
+};
 
+// Written by TrackFusion after each fused frame
+struct RadarAssignment {
+    std::vector<int> owned;  // Aircraft this radar polls, sorted
+};
 
-// Shared memory size
-#define SHARED_MEMORY_SIZE sizeof(SharedMemory)  // Update this based on the size of your buffer
+struct RadarStats {
+    std::string name;
+    uint64_t frames = 0;
+    uint64_t polls = 0;           // Position requests sent
+    uint64_t reports = 0;         // Positions inside the coverage, passed to fusion
+    uint64_t outsideCoverage = 0; // Answers measured outside the coverage, dropped
+};
 
 class Radar {
 public:
-	Radar(uint64_t& tick_counter);
+	Radar(const RadarConfig& config, TrackFusion& fusion);
     ~Radar();
 
-    void ListenAirspaceArrivalAndDeparture();
+    // Radars of RADAR_CONFIG_FILE-style file; one radar covering everything if it cannot be read
+    static std::vector<RadarConfig> loadConfig(const std::string& path);
+
     void ListenUpdatePosition();
 
-    // Shared memory write method
-    void writeToSharedMemory();
-    void clearSharedMemory();
+    // True if the position is inside the coverage grown by `margin` on every side
+    bool covers(double x, double y, double z, double margin = 0.0) const;
+
+    // Fusion stage only: reads the frames, writes the assignments
+    TripleBuffer<RadarFrame>& getFrames() { return frames; }
+    TripleBuffer<RadarAssignment>& getAssignments() { return assignments; }
+
+    const RadarConfig& getConfig() const { return config; }
+    RadarStats getStats() const;
+
+    // Deadline statistics of the polling loop
+    DeadlineStats getPollDeadlineStats();
 
 
 private:
 
-    uint64_t& tick_counter_ref;  // Store tick_counter as a reference
-    std::unordered_set<int> planesInAirspace ;
+    RadarConfig config;
+    TrackFusion& fusion;
+
+    std::vector<int> planesInAirspace;  // Snapshot of the fusion's track set for the current period
 
-    std::thread Arrival_Departure;
     std::thread UpdatePosition;
 
-    void addPlaneToAirspace(Message msg);
-    void removePlaneFromAirspace(int ID);
     void pollAirspace();
     msg_plane_info getAircraftData(int id);
+    // Close the connections of the aircraft this radar no longer owns, or that left
+    void releaseConnections(const std::vector<int>& owned);
 
-    name_attach_t* Radar_channel;
-
-    std::mutex airspaceMutex;
-    std::mutex bufferSwitchMutex;
+    std::map<int, IpcConnection> connections;  // Per aircraft, poll thread only
 
-
-    std::vector<msg_plane_info>& getActiveBuffer();
-
-    std::vector<msg_plane_info> planesInAirspaceData[2];
-    std::atomic<int> activeBufferIndex; // Index of the active buffer
+    // Written by pollAirspace, read by TrackFusion; neither waits for the other
+    TripleBuffer<RadarFrame> frames;
+    // Written by TrackFusion, read by pollAirspace
+    TripleBuffer<RadarAssignment> assignments;
 
     ATCTimer timer;
+    DeadlineMonitor pollDeadline;  // Execution time and jitter of each poll period
 
-    // Shared memory pointer
-    SharedMemory* sharedMemPtr;  // Update pointer type to match the structure
     bool wasAirspaceEmpty = true;  // Track if airspace was empty last time
-    int shm_fd = -1;
     std::atomic<bool> stopThreads;
 
+    std::atomic<uint64_t> frameCount{0};
+    std::atomic<uint64_t> pollCount{0};
+    std::atomic<uint64_t> reportCount{0};
+    std::atomic<uint64_t> outsideCount{0};
+
     void shutdown();
 
 
@@ -0,0 +1,386 @@
+#include "TrackFusion.h"
+#include <algorithm>
+#include <iomanip>
+
+
+TrackFusion::TrackFusion() : Radar_channel("chris_Radar"), stopThreads(false), sharedMemPtr(nullptr) {
+    // Create the segment (and its publish notification) before any thread can write to it
+    clearSharedMemory();
+    MemoryWarmup::prefault(inAirspace, TRACKSET_CAPACITY);
+    MemoryWarmup::prefault(fusedFrame, TRACKSET_CAPACITY);
+	// Start the thread listening to airspace events
+    Arrival_Departure = std::thread(&TrackFusion::ListenAirspaceArrivalAndDeparture, this);
+}
+
+TrackFusion::~TrackFusion() {
+    stop();
+    // Publish a final empty frame so that waiting readers wake up and see the airspace is empty
+    tracks.clear();
+    writeToSharedMemory();
+    if (sharedMemPtr) {
+        munmap(sharedMemPtr, SHARED_MEMORY_SIZE);
+    }
+    printStats(std::cout);
+}
+
+void TrackFusion::start(const std::vector<Radar*>& radars, FlightArchive* archive) {
+    this->radars = radars;
+    this->archive = archive;
+    fusion = std::thread(&TrackFusion::fuseLoop, this);
+}
+
+void TrackFusion::stop() {
+    // Set stop flag and wait for threads to complete
+    stopThreads.store(true);
+    framesReady.notify_all();
+
+    // Close the channel, which also unblocks the arrival/departure thread
+    Radar_channel.detach();
+
+    if (Arrival_Departure.joinable()) {
+        Arrival_Departure.join();
+    }
+    if (fusion.joinable()) {
+        fusion.join();
+    }
+    // The radars are destroyed before the fusion
+    for (const Radar* radar : radars) {
+        radarStats.push_back(radar->getStats());
+    }
+    radars.clear();
+}
+
+void TrackFusion::notify() {
+    {
+        std::lock_guard<std::mutex> lock(notifyMutex);
+        pending = true;
+    }
+    framesReady.notify_one();
+}
+
+//Coen320_Lab (Task0): Create channel to be reachable by radar that wants to poll the Airplane
+//Radar Channel name should contain your group name
+//To choose the channel with concatenating your group name with "Radar"
+//Note: It is critical to not interfere other groups
+void TrackFusion::ListenAirspaceArrivalAndDeparture() {
+	ThreadProfiles::apply("radar.listen");
+	MemoryWarmup::prefaultStack();
+	// The channel is attached by the constructor, before aircraft can try to reach it
+	if (!Radar_channel.isAttached()) {
+		std::cerr << "Failed to create channel for Radar" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	// Simulated listening for aircraft arrivals and departures
+    while (!stopThreads.load()) {
+        // Replace with IPC
+        Message msg;
+        size_t received = 0;
+        int rcvid = Radar_channel.receive(&msg, sizeof(msg), received);
+        if (rcvid == -1) {
+        	// Silently skip if receive fails, but no crash happens
+        	// std::cerr << "Error receiving airspace message:" << strerror(errno) << std::endl;
+        	continue;
+        }
+        if (!msg.valid(received)) {
+            Radar_channel.error(rcvid, EPROTO);
+            continue;
+        }
+
+        // Reply back to the client
+        int msg_ret = msg.header.planeID;
+        Radar_channel.reply(rcvid, 0, &msg_ret, sizeof(msg_ret)); // Send plane's ID back to airplane
+
+        switch (msg.header.type) {
+        case MessageType::ENTER_AIRSPACE:
+            addPlaneToAirspace(msg);
+            break;
+        case MessageType::EXIT_AIRSPACE:
+            removePlaneFromAirspace(msg.header.planeID);
+            break;
+        default:
+        	//All other messages dropped
+            //std::cerr << "Unknown airspace message type" << std::endl;
+        	break;
+        }
+
+    }
+}
+
+void TrackFusion::fuseLoop() {
+    ThreadProfiles::apply("radar.fusion");
+    MemoryWarmup::prefaultStack();
+
+    std::unique_lock<std::mutex> lock(notifyMutex);
+    while (!stopThreads.load()) {
+        // Woken by each radar frame; the timeout still ages out tracks when no radar reports
+        framesReady.wait_for(lock, std::chrono::milliseconds(RADAR_PERIOD_MS),
+                             [this] { return pending || stopThreads.load(); });
+        pending = false;
+        lock.unlock();
+
+        planesInAirspace.snapshot(inAirspace);
+        bool merged = false;
+        for (size_t i = 0; i < radars.size(); ++i) {
+            // Latest whole frame of each radar; a radar that has not published since keeps its turn
+            if (radars[i]->getFrames().update()) {
+                merge(radars[i]->getFrames().front(), i);
+                merged = true;
+            }
+        }
+        size_t before = tracks.size();
+        prune();
+        if (merged || tracks.size() != before) {
+            writeToSharedMemory();
+        }
+        // Also after an arrival, so that the new aircraft is polled from the next period
+        assign();
+
+        lock.lock();
+    }
+}
+
+void TrackFusion::merge(const RadarFrame& frame, size_t radar) {
+    uint64_t now = TimeBase::nowNs();
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.radarFrames++;
+    for (const msg_plane_info& report : frame.planes) {
+        // A plane that left since the radar polled it stays out
+        if (!std::binary_search(inAirspace.begin(), inAirspace.end(), report.id)) {
+            continue;
+        }
+        auto owner = owners.find(report.id);
+        if (owner != owners.end()) {
+            owner->second.searching = false;
+        }
+        auto it = tracks.find(report.id);
+        if (it == tracks.end()) {
+            tracks.emplace(report.id, FusedTrack{report, now});
+            stats.updates++;
+        } else if (report.stateTime > it->second.info.stateTime) {
+            it->second = FusedTrack{report, now};  // Newest aircraft state wins
+            stats.updates++;
+        } else if (report.stateTime == it->second.info.stateTime) {
+            it->second.updated = now;  // Same state from the previous owner, around a handoff
+            stats.duplicates++;
+        } else {
+            stats.stale++;
+        }
+    }
+    // Not seen by its owner: the next radar looks for it
+    for (int id : frame.missed) {
+        auto owner = owners.find(id);
+        if (owner == owners.end() || owner->second.radar != radar) {
+            continue;  // Already given to another radar
+        }
+        owner->second = Owner{(radar + 1) % radars.size(), true};
+        stats.searches++;
+    }
+}
+
+void TrackFusion::prune() {
+    uint64_t now = TimeBase::nowNs();
+    const uint64_t timeoutNs = FUSION_TRACK_TIMEOUT_MS * 1000000ULL;
+    for (auto it = tracks.begin(); it != tracks.end();) {
+        if (!std::binary_search(inAirspace.begin(), inAirspace.end(), it->first)) {
+            it = tracks.erase(it);  // Left the airspace
+        } else if (now - it->second.updated > timeoutNs) {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.timedOut++;
+            it = tracks.erase(it);  // No radar sees it any more: every radar looks for it again
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t TrackFusion::chooseOwner(size_t current, const msg_plane_info& track) const {
+    // Well inside the current owner's volume: no handoff
+    if (radars[current]->covers(track.PositionX, track.PositionY, track.PositionZ, -RADAR_HANDOFF_MARGIN)) {
+        return current;
+    }
+    for (size_t i = 0; i < radars.size(); ++i) {
+        if (radars[i]->covers(track.PositionX, track.PositionY, track.PositionZ, -RADAR_HANDOFF_MARGIN)) {
+            return i;
+        }
+    }
+    // Near the edge of every volume (or between them): the current owner, else any radar that sees it
+    if (radars[current]->covers(track.PositionX, track.PositionY, track.PositionZ)) {
+        return current;
+    }
+    for (size_t i = 0; i < radars.size(); ++i) {
+        if (radars[i]->covers(track.PositionX, track.PositionY, track.PositionZ)) {
+            return i;
+        }
+    }
+    return current;
+}
+
+void TrackFusion::assign() {
+    if (radars.empty()) {
+        return;
+    }
+    for (Radar* radar : radars) {
+        radar->getAssignments().back().owned.clear();
+    }
+    // The airspace snapshot is sorted, so every list comes out sorted
+    for (int id : inAirspace) {
+        auto owner = owners.find(id);
+        if (owner == owners.end()) {
+            owner = owners.emplace(id, Owner{static_cast<unsigned>(id) % radars.size(), true}).first;
+        }
+        auto track = tracks.find(id);
+        if (track != tracks.end() && !owner->second.searching) {
+            size_t radar = chooseOwner(owner->second.radar, track->second.info);
+            if (radar != owner->second.radar) {
+                owner->second.radar = radar;
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.handoffs++;
+            }
+        }
+        radars[owner->second.radar]->getAssignments().back().owned.push_back(id);
+    }
+    // Aircraft that left the airspace
+    for (auto it = owners.begin(); it != owners.end();) {
+        if (std::binary_search(inAirspace.begin(), inAirspace.end(), it->first)) {
+            ++it;
+        } else {
+            it = owners.erase(it);
+        }
+    }
+    for (Radar* radar : radars) {
+        radar->getAssignments().publish();
+    }
+}
+
+void TrackFusion::addPlaneToAirspace(const Message& msg) {
+	int plane_data = msg.header.planeID;
+    if (!planesInAirspace.add(plane_data)) {
+        std::cerr << "Radar: cannot track plane " << plane_data << " (already tracked or " << TRACKSET_CAPACITY << " planes in airspace)" << std::endl;
+        return;
+    }
+    std::cout << "Plane " << plane_data << " added to airspace" << std::endl;
+    notify();  // Fusion gives it a radar
+}
+
+void TrackFusion::removePlaneFromAirspace(int planeID) {
+	planesInAirspace.remove(planeID);  // Publishes a new version of the track set; fusion drops its track
+	std::cout << "Plane " << planeID << " removed from airspace" << std::endl;
+}
+
+void TrackFusion::writeToSharedMemory() {
+    // Mapped once by clearSharedMemory(): no mapping (and no page fault) per frame
+    SharedMemory* ptr = sharedMemPtr;
+    if (!ptr) {
+        return;
+    }
+
+    // Determine capacity of plane_data safely:
+    size_t capacity = sizeof(ptr->plane_data) / sizeof(ptr->plane_data[0]);
+
+    // One track per plane, in plane ID order
+    fusedFrame.clear();
+    for (const auto& entry : tracks) {
+        fusedFrame.push_back(entry.second.info);
+    }
+
+    // Readers copy the frame under frame_mutex, so they never see a half-written frame
+    pthread_mutex_lock(&ptr->frame_mutex);
+
+    // Tick at which the frame was completed
+    ptr->timestamp = TimeBase::tick();
+
+    // copy at most capacity elements
+    size_t to_copy = std::min(fusedFrame.size(), capacity);
+    ptr->is_empty.store(to_copy == 0);
+    ptr->count = to_copy;
+    std::memcpy(ptr->plane_data, fusedFrame.data(), to_copy * sizeof(msg_plane_info));
+
+    // Frame is complete: announce the new generation to every waiting reader
+    ptr->publish_time = TimeBase::nowNs();
+    ptr->generation++;
+    pthread_cond_broadcast(&ptr->frame_cond);
+    pthread_mutex_unlock(&ptr->frame_mutex);
+
+    if (archive) {
+        archive->append(fusedFrame);  // Copied into the archive's ring, never waits for the disk
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.published++;
+}
+
+void TrackFusion::clearSharedMemory() {
+	const char *name = "/radar_shm";
+
+	// Create shared memory
+    int shm_fd = shm_open(name, O_CREAT | O_RDWR, 0666);
+    if (shm_fd == -1) {
+        fprintf(stderr, "shm_open (create) failed: %s\n", strerror(errno));
+        return;
+    }
+
+	// Configure size of shared memory
+    // Ensure the shared memory is the required size
+    if (!MemoryWarmup::sizeShared(shm_fd, SHARED_MEMORY_SIZE)) {
+        fprintf(stderr, "ftruncate failed: %s\n", strerror(errno));
+        close(shm_fd);
+        return;
+    }
+
+    // Kept mapped for every frame; locked and pre-faulted (huge pages where supported)
+    void *shared_mem = MemoryWarmup::mapShared(shm_fd, SHARED_MEMORY_SIZE, PROT_READ | PROT_WRITE);
+    if (shared_mem == MAP_FAILED) {
+        fprintf(stderr, "mmap (create) failed: %s\n", strerror(errno));
+        close(shm_fd);
+        return;
+    }
+
+    SharedMemory* ptr = static_cast<SharedMemory*>(shared_mem);
+    std::memset(ptr, 0, sizeof(SharedMemory));
+    ptr->is_empty = 1;     // mark empty
+    ptr->count = 0;
+    ptr->timestamp = 0;
+    ptr->generation = 0;
+
+    // Process-shared mutex/condvar used to notify readers of each published frame
+    pthread_mutexattr_t mutex_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&ptr->frame_mutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&ptr->frame_cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+	// The mapping stays valid after the file descriptor is closed
+//	shm_unlink(name);
+	close(shm_fd);
+    sharedMemPtr = ptr;
+}
+
+FusionStats TrackFusion::getStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+void TrackFusion::printStats(std::ostream& os) {
+    FusionStats s = getStats();
+    std::vector<RadarStats> perRadar = radarStats;
+    for (const Radar* radar : radars) {
+        perRadar.push_back(radar->getStats());
+    }
+    os << "\n================= Track Fusion =================\n"
+       << perRadar.size() << " radars, " << s.radarFrames << " radar frames merged, " << s.published << " fused frames published\n"
+       << "Reports: " << s.updates << " accepted, " << s.duplicates << " duplicates, " << s.stale << " stale; "
+       << s.timedOut << " tracks timed out\n"
+       << "Ownership: " << s.handoffs << " handoffs between radars, " << s.searches << " aircraft passed on after a miss\n"
+       << std::left << std::setw(12) << "Radar" << std::right << std::setw(10) << "frames"
+       << std::setw(10) << "polls" << std::setw(10) << "reports" << std::setw(16) << "outside cover" << "\n";
+    for (const RadarStats& r : perRadar) {
+        os << std::left << std::setw(12) << r.name << std::right << std::setw(10) << r.frames
+           << std::setw(10) << r.polls << std::setw(10) << r.reports << std::setw(16) << r.outsideCoverage << "\n";
+    }
+}
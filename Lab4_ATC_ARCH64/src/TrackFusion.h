@@ -0,0 +1,139 @@
+/*
+ * The TrackFusion class merges the frames of every Radar into one track table
+ * and publishes it to the shared frame (/radar_shm).
+ *
+ * *****Airspace*****:
+ * It owns the "chris_Radar" channel: aircraft announce entering and leaving
+ * the airspace there, and the IDs go into a TrackSet that every radar reads
+ * lock-free once per period.
+ *
+ * *****Fusion*****:
+ * Each time a radar publishes a frame, the fusion thread takes the latest
+ * frame of every radar and merges the reports into the table, keyed by plane
+ * ID. A report replaces the track only if its stateTime is newer; the same
+ * aircraft state reported again (by the old and the new owner around a
+ * handoff) is a duplicate and is dropped, and an older state arriving late is
+ * stale. Tracks of aircraft
+ * that left the airspace, or that no radar reported for FUSION_TRACK_TIMEOUT_MS,
+ * are removed. The table is then published whole, in plane ID order. The
+ * radars never wait for the fusion (their frames arrive through a
+ * TripleBuffer), but the fusion does share frame_mutex with the readers of
+ * /radar_shm while it copies the table in.
+ *
+ * *****Ownership*****:
+ * Each aircraft in the airspace is polled by one radar, its owner, given to
+ * the radars in their RadarAssignment after every fusion:
+ *   - a located aircraft stays with its owner while its track is more than
+ *     RADAR_HANDOFF_MARGIN inside the owner's volume; nearer the edge it is
+ *     handed to the first radar (in file order) it is that far inside, so it
+ *     changes radar in the overlap before leaving the old coverage and does
+ *     not go back and forth on the boundary
+ *   - an aircraft that just entered starts with radar (ID mod radar count)
+ *   - an aircraft its owner missed (RadarFrame::missed) goes to the next radar
+ *     in turn until one reports it
+ */
+
+#ifndef TRACKFUSION_H_
+#define TRACKFUSION_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include "Msg_structs.h"
+#include "Ipc.h"
+#include "TrackSet.h"
+#include "Radar.h"
+#include "FlightArchive.h"
+
+#define SHARED_MEMORY_SIZE sizeof(SharedMemory)  // Update this based on the size of your buffer
+#define FUSION_TRACK_TIMEOUT_MS 3000  // Track dropped when no radar reported it for this long
+
+struct FusionStats {
+	uint64_t radarFrames = 0;      // Radar frames merged
+	uint64_t published = 0;        // Fused frames written to shared memory
+	uint64_t updates = 0;          // Reports that created or refreshed a track
+	uint64_t duplicates = 0;       // Same aircraft state reported by another radar
+	uint64_t stale = 0;            // Reports older than the track
+	uint64_t timedOut = 0;         // Tracks no radar reported for FUSION_TRACK_TIMEOUT_MS
+	uint64_t handoffs = 0;         // Located aircraft given to another radar
+	uint64_t searches = 0;         // Aircraft passed on after their owner missed them
+};
+
+class TrackFusion {
+public:
+	// Creates the shared frame and starts accepting airspace arrivals and departures
+	TrackFusion();
+	~TrackFusion();
+
+	// Start fusing the frames of these radars; they must outlive stop(), which
+	// keeps their final statistics and lets go of them. Each
+	// published frame is also handed to the archive, if any, which must outlive the fusion
+	void start(const std::vector<Radar*>& radars, FlightArchive* archive = nullptr);
+	// Stop the fusion and airspace threads
+	void stop();
+
+	// Aircraft currently in the airspace
+	const TrackSet& airspace() const { return planesInAirspace; }
+
+	// Called by a radar after it published a frame
+	void notify();
+
+	FusionStats getStats();
+	void printStats(std::ostream& os);
+
+private:
+	struct FusedTrack {
+		msg_plane_info info;
+		uint64_t updated;  // TimeBase::nowNs() of the last report accepted
+	};
+
+	struct Owner {
+		size_t radar;    // Index in radars
+		bool searching;  // Not reported since it entered or was missed: kept off the handoff
+	};
+
+	void ListenAirspaceArrivalAndDeparture();
+	void addPlaneToAirspace(const Message& msg);
+	void removePlaneFromAirspace(int ID);
+
+	void fuseLoop();
+	void merge(const RadarFrame& frame, size_t radar);
+	void prune();
+	void assign();
+	// Radar that should poll a located aircraft now owned by `current`
+	size_t chooseOwner(size_t current, const msg_plane_info& track) const;
+
+	// Shared memory methods
+	void writeToSharedMemory();
+	void clearSharedMemory();
+
+	TrackSet planesInAirspace;      // Written on enter/exit, read lock-free by the radars
+	std::vector<int> inAirspace;    // Snapshot of planesInAirspace for the current fusion
+	IpcServer Radar_channel;
+	std::thread Arrival_Departure;
+
+	std::vector<Radar*> radars;
+	std::vector<RadarStats> radarStats;     // Taken by stop(), once the radars may be gone
+	std::thread fusion;
+	std::map<int, FusedTrack> tracks;       // Fused track table, fusion thread only
+	std::map<int, Owner> owners;            // Radar polling each aircraft, fusion thread only
+	std::vector<msg_plane_info> fusedFrame; // Table as written to shared memory
+	FlightArchive* archive = nullptr;
+
+	std::mutex notifyMutex;
+	std::condition_variable framesReady;
+	bool pending = false;  // A radar published since the last fusion
+	std::atomic<bool> stopThreads;
+
+	// Shared memory pointer
+	SharedMemory* sharedMemPtr;  // Mapped by clearSharedMemory() for the life of the fusion
+
+	std::mutex statsMutex;
+	FusionStats stats;
+};
+
+#endif /* TRACKFUSION_H_ */
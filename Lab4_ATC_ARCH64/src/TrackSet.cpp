@@ -0,0 +1,83 @@
+#include "TrackSet.h"
+#include <thread>
+
+TrackSet::TrackSet() : count(0), version(0) {
+	for (std::atomic<int>& id : ids) {
+		id.store(0, std::memory_order_relaxed);
+	}
+}
+
+void TrackSet::beginWrite() {
+	version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	// Readers that see any of the following stores also see the odd version
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+void TrackSet::endWrite() {
+	version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool TrackSet::add(int id) {
+	std::lock_guard<std::mutex> lock(writeMutex);
+	size_t n = count.load(std::memory_order_relaxed);
+	if (n >= TRACKSET_CAPACITY) {
+		return false;
+	}
+	// Insertion point in the sorted array
+	size_t pos = 0;
+	while (pos < n && ids[pos].load(std::memory_order_relaxed) < id) {
+		++pos;
+	}
+	if (pos < n && ids[pos].load(std::memory_order_relaxed) == id) {
+		return false;
+	}
+
+	beginWrite();
+	for (size_t i = n; i > pos; --i) {
+		ids[i].store(ids[i - 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+	ids[pos].store(id, std::memory_order_relaxed);
+	count.store(n + 1, std::memory_order_relaxed);
+	endWrite();
+	return true;
+}
+
+bool TrackSet::remove(int id) {
+	std::lock_guard<std::mutex> lock(writeMutex);
+	size_t n = count.load(std::memory_order_relaxed);
+	size_t pos = 0;
+	while (pos < n && ids[pos].load(std::memory_order_relaxed) != id) {
+		++pos;
+	}
+	if (pos == n) {
+		return false;
+	}
+
+	beginWrite();
+	for (size_t i = pos; i + 1 < n; ++i) {
+		ids[i].store(ids[i + 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+	count.store(n - 1, std::memory_order_relaxed);
+	endWrite();
+	return true;
+}
+
+uint64_t TrackSet::snapshot(std::vector<int>& out) const {
+	while (true) {
+		uint64_t before = version.load(std::memory_order_acquire);
+		if (before & 1) {
+			std::this_thread::yield();  // A writer is in the middle of a change
+			continue;
+		}
+		size_t n = count.load(std::memory_order_relaxed);
+		out.resize(n);
+		for (size_t i = 0; i < n; ++i) {
+			out[i] = ids[i].load(std::memory_order_relaxed);
+		}
+		// Order the copy before the second version read
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (version.load(std::memory_order_relaxed) == before) {
+			return before;
+		}
+	}
+}
@@ -0,0 +1,60 @@
+/*
+ * The TrackSet class holds the IDs of the aircraft currently in the airspace.
+ * It is written by the arrival/departure thread and read by the polling thread
+ * of the Radar without any lock on the read side.
+ *
+ * *****Layout*****:
+ * A flat array of IDs kept in ascending order, with its count and a version
+ * number (epoch). The capacity matches the frame published in shared memory.
+ *
+ * *****Versioning*****:
+ * Every add or remove publishes a new version: the version is made odd while
+ * the array changes and even again once the change is complete (a seqlock).
+ * snapshot() copies the array and retries if the version moved meanwhile, so
+ * the poller takes one consistent, immutable copy per period instead of
+ * locking the set once per aircraft.
+ *
+ * Writers are serialized by a mutex; enter and exit events are rare compared
+ * to the reads.
+ */
+
+#ifndef TRACKSET_H_
+#define TRACKSET_H_
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "Msg_structs.h"
+
+#define TRACKSET_CAPACITY SHARED_MEMORY_MAX_PLANES  // One published frame
+
+class TrackSet {
+public:
+	TrackSet();
+
+	// Returns false if the ID is already present or the set is full
+	bool add(int id);
+	// Returns false if the ID was not present
+	bool remove(int id);
+
+	// Replace `out` with a consistent copy of the IDs; returns the version copied
+	uint64_t snapshot(std::vector<int>& out) const;
+
+	// Lock-free reads of the current state
+	bool empty() const { return count.load(std::memory_order_acquire) == 0; }
+	size_t size() const { return count.load(std::memory_order_acquire); }
+	uint64_t getVersion() const { return version.load(std::memory_order_acquire); }
+
+private:
+	void beginWrite();
+	void endWrite();
+
+	std::atomic<int> ids[TRACKSET_CAPACITY];
+	std::atomic<size_t> count;
+	std::atomic<uint64_t> version;  // Odd while a writer is changing the array
+	std::mutex writeMutex;
+};
+
+#endif /* TRACKSET_H_ */
@@ -0,0 +1,80 @@
+/*
+ * The TripleBuffer class hands complete frames from one writer thread to one
+ * reader thread without locks and without either side ever waiting.
+ *
+ * *****Buffers*****:
+ * back    the frame the writer is filling; only the writer touches it
+ * middle  the latest published frame, not taken by the reader yet
+ * front   the frame the reader is using; only the reader touches it
+ *
+ * publish() swaps back and middle in one atomic exchange, so a frame becomes
+ * visible only once it is complete. update() swaps front and middle if a newer
+ * frame was published; otherwise the reader keeps its current frame. The
+ * writer can publish any number of frames while the reader holds front(): the
+ * reader always gets the latest whole frame, never a partial one.
+ *
+ * The buffers are reused, so a vector in T keeps its capacity between frames.
+ *
+ * *****Scope*****:
+ * Used within the Lab4 process only: each Radar hands its frames to
+ * TrackFusion, and TrackFusion hands each Radar its assignment, so a slow
+ * fusion pass never stretches a poll period and the other way around. The
+ * fused frame in /radar_shm is still published under frame_mutex (see
+ * SharedMemory), and the other processes read it with that lock.
+ */
+
+#ifndef TRIPLEBUFFER_H_
+#define TRIPLEBUFFER_H_
+
+#include <atomic>
+
+template <typename T>
+class TripleBuffer {
+public:
+	TripleBuffer() : backIndex(0), frontIndex(1), middle(2) {}
+
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	// Writer: the frame to fill next
+	T& back() {
+		return buffers[backIndex];
+	}
+
+	// Writer: make back() the latest frame and start on a free buffer
+	void publish() {
+		int previous = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel);
+		backIndex = previous & INDEX;
+	}
+
+	// Reader: take the latest frame if one was published since the last call; returns true if so
+	bool update() {
+		if (!(middle.load(std::memory_order_acquire) & FRESH)) {
+			return false;
+		}
+		int previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+		frontIndex = previous & INDEX;
+		return true;
+	}
+
+	// Setup only, before the writer and the reader start: buffer 0, 1 or 2
+	T& buffer(int index) {
+		return buffers[index];
+	}
+
+	// Reader: the frame taken by the last update()
+	const T& front() const {
+		return buffers[frontIndex];
+	}
+
+private:
+	static const int INDEX = 3;  // Buffer index bits of middle
+	static const int FRESH = 4;  // Set in middle by publish(), cleared by update()
+
+	T buffers[3];
+	int backIndex;               // Writer only
+	int frontIndex;              // Reader only
+	std::atomic<int> middle;
+};
+
+#endif /* TRIPLEBUFFER_H_ */
@@ -1,30 +1,97 @@
 #include "AirTrafficControl.h"
 #include "Radar.h"
+#include "TrackFusion.h"
+#include "FlightArchive.h"
 #include "ATCTimer.h"
+#include "TimeBase.h"
+#include "ThreadProfile.h"
+#include "MemoryWarmup.h"
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
 
-// Global tick counter
-uint64_t tick_counter = 0; // Counter for time ticks
 std::atomic<bool> running(true);  // Flag to control the timer thread
 
-// Function to increment the tick_counter every second
+// Function to advance the shared simulation tick every second, on the same drift-free
+// 1 s deadlines as the Radar's timer; missed seconds are still counted
 void timer_tick() {
+    ThreadProfiles::apply("timebase.tick");
+    MemoryWarmup::prefaultStack();
+    ATCTimer tickTimer(1, 0);
     while (running) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));  // Sleep for 1 second
-        tick_counter++;  // Increment the tick counter
-        //std::cout << "Tick counter: " << tick_counter << std::endl;  // Optionally print it
+        uint64_t missed = tickTimer.waitTimer();  // Wait for the next 1 s deadline
+        TimeBase::advance(1 + missed);  // Visible to every ATC process
+        //std::cout << "Tick: " << TimeBase::tick() << std::endl;  // Optionally print it
     }
 }
 
+// Prints the archived positions of one plane between t1 and t2 (s since the start of the recording)
+int queryArchive(const std::string& path, int planeID, double t1, double t2) {
+    std::vector<ArchiveRow> rows;
+    if (!FlightArchive::query(path, planeID, t1, t2, rows)) {
+        return 1;
+    }
+    std::cout << "time_s,x,y,z,vx,vy,vz,poll_delay_ms,command_seq\n" << std::fixed;
+    for (const ArchiveRow& row : rows) {
+        const msg_plane_info& p = row.info;
+        std::cout << std::setprecision(3) << row.time / 1e9 << ","
+                  << p.PositionX << "," << p.PositionY << "," << p.PositionZ << ","
+                  << p.VelocityX << "," << p.VelocityY << "," << p.VelocityZ << ","
+                  << row.pollDelay / 1e6 << "," << p.commandSeq << "\n";
+    }
+    std::cerr << rows.size() << " positions of plane " << planeID << "\n";
+    return 0;
+}
+
+// Usage: Lab4_ATC_ARCH64 [--archive <file>]
+//        Lab4_ATC_ARCH64 --query <file> <planeID> <t1> <t2>
+// Every published frame is archived to <file> (default ARCHIVE_FILE); --query
+// prints the archived positions of a plane between t1 and t2 seconds and exits.
+int main(int argc, char* argv[]) {
+    std::string archivePath = ARCHIVE_FILE;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--archive" && i + 1 < argc) {
+            archivePath = argv[++i];
+        } else if (arg == "--query" && i + 4 < argc) {
+            return queryArchive(argv[i + 1], std::atoi(argv[i + 2]), std::atof(argv[i + 3]), std::atof(argv[i + 4]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--archive <file>]\n"
+                      << "       " << argv[0] << " --query <file> <planeID> <t1> <t2>\n";
+            return 1;
+        }
+    }
+
+    // Scheduling policy, priority and CPUs of each thread role (threads.conf)
+    ThreadProfiles::loadDefault();
+    // Warm phase: everything mapped from here on stays resident (see MemoryWarmup.h)
+    MemoryWarmup::lockProcessMemory();
 
-int main() {
     // Create the AirTrafficControl instance
     AirTrafficControl atc;
 
     atc.readPlanesFromFile("planes.txt");  // Ensure the file is in the correct directory
 
-    Radar radar(tick_counter);
+    // Publish the simulation time base (tick 0 is now) before anything is stamped with it
+    if (!TimeBase::create(1000000000ULL)) {
+        return 1;
+    }
+
+    // Outlives the fusion, which hands it every published frame
+    FlightArchive archive(archivePath);
+    // Airspace and fused frame first: the radars poll the aircraft it knows of
+    TrackFusion fusion;
+    std::vector<std::unique_ptr<Radar>> radars;
+    std::vector<Radar*> fused;
+    for (const RadarConfig& config : Radar::loadConfig(RADAR_CONFIG_FILE)) {
+        radars.emplace_back(new Radar(config, fusion));
+        fused.push_back(radars.back().get());
+    }
+    fusion.start(fused, &archive);
 
-    // Start a timer thread to increment tick_counter every second
+    // Start a timer thread to advance the simulation tick every second
     std::thread timer_thread(timer_tick);
 
     atc.startPlanes();
@@ -34,5 +101,8 @@ int main() {
     	running = false;  // Stop the timer thread
     	timer_thread.join();  // Wait for the timer thread to finish
     }
+    fusion.stop();  // Before the radars it reads are destroyed
+    ThreadProfiles::printStats(std::cout);
+    MemoryWarmup::printReport(std::cout);
     return 0;
 }